@@ -56,8 +56,12 @@
 #define TRAPEZOIDAL     1
 #define GAUSSIAN		2
 
+#define MEMBERSHIP_TABLE		0	// membership values stored in a vector of npoints
+#define MEMBERSHIP_ANALYTIC		1	// membership values evaluated from the function parameters
+#define MEMBERSHIP_INTERLEAVED	2	// membership values of all the sets stored per point ([point][term])
+
 /**
- * 	Allocates memory for Fuzzy Sets
+ * 	Allocates memory for Fuzzy Sets (one 64 byte aligned block holding the sets, their universe and vectors)
  * 	@param sets fuzzy sets object pointer
  * 	@param nsets number of sets
  * 	@param npoints  number of discretization points
@@ -92,12 +96,66 @@
  *		}
  * 		.
  * 		.
+ *		FreeSets (temperature);
  *		return 0;
  *	}
  *	@endcode
  */
 int InitializeSets (struct SSets **sets, int nsets, long npoints, double start_uod, double stop_uod, double value);
 
+/**
+ * 	Allocates Fuzzy Sets evaluated in closed form (no discretization vector is allocated)
+ * 	@param sets fuzzy sets object pointer
+ * 	@param nsets number of sets
+ * 	@param start_uod universe of discourse start value
+ * 	@param stop_uod universe of discourse stop value
+ *  @return TRUE if success or FALSE if it fails
+ *  @note	Analytic sets can be used as rule inputs (their membership degree is computed exactly
+ *	from the parameters given to Fuzzification (), without rounding to a discretization point).
+ *	Output sets must still be allocated with InitializeSets (). Usage:
+ *	@code
+ *	struct SSets *temperature;
+ *
+ *	if (! InitializeAnalyticSets (&temperature, 3, 5.0, 45.0))
+ *		return 0;
+ *
+ *	Fuzzification (&temperature[TEMP_COLD], TRIANGULAR, START_COLD, MID_COLD, END_COLD);
+ *	@endcode
+ */
+int InitializeAnalyticSets (struct SSets **sets, int nsets, double start_uod, double stop_uod);
+
+/**
+ * 	Allocates Fuzzy Sets with the membership values of all the sets interleaved per discretization point
+ * 	@param sets fuzzy sets object pointer
+ * 	@param nsets number of sets
+ * 	@param npoints  number of discretization points
+ * 	@param start_uod universe of discourse start value
+ * 	@param stop_uod universe of discourse stop value
+ * 	@param value  initialization value (normally 0 or NULL)
+ *  @return TRUE if success or FALSE if it fails
+ *  @note	The degrees of every set at one point are stored next to each other (rows are padded to 1, 2, 4, 8
+ *	or a multiple of 8 values), so MembershipVector () returns the whole degree vector of a crisp value from
+ *	a single cache line. Interleaved sets can be used as rule inputs, output sets must be allocated with
+ *	InitializeSets (). Usage:
+ *	@code
+ *	struct SSets *temperature;
+ *
+ *	if (! InitializeInterleavedSets (&temperature, 3, DISCRETE_PTS, 5.0, 45.0, 0.0))
+ *		return 0;
+ *
+ *	Fuzzification (&temperature[TEMP_COLD], TRIANGULAR, START_COLD, MID_COLD, END_COLD);
+ *	@endcode
+ */
+int InitializeInterleavedSets (struct SSets **sets, int nsets, long npoints, double start_uod, double stop_uod, double value);
+
+/**
+ * 	Releases Fuzzy Sets allocated with InitializeSets (), InitializeInterleavedSets () or InitializeAnalyticSets ()
+ * 	@param sets fuzzy sets object (the pointer returned by the initialization function)
+ *  @return nothing
+ *  @note Membership vectors live inside the sets allocation, so they must not be released with free ()
+ */
+void FreeSets (struct SSets *sets);
+
 /**
  * 	Creates the membership functions (wrapper for the Fuzzification function, use this one instead)
  * 	@param type	membership function type (TRIANGULAR, TRAPEZOIDAL, GAUSSIAN)
@@ -148,9 +206,9 @@ int InitializeSets (struct SSets **sets, int nsets, long npoints, double start_u
  *  int main (void)
  *	{
  *  	int ret;
- * 		double *fuzzified_values_cold;
- * 		double *fuzzified_values_warm;
- * 		double *fuzzified_values_hot;
+ * 		fuzzy_t *fuzzified_values_cold;
+ * 		fuzzy_t *fuzzified_values_warm;
+ * 		fuzzy_t *fuzzified_values_hot;
  *
  *	 	// membership functions fuzzyfication
  *		fuzzified_values_cold = MembershipFunction (TRIANGULAR, DISCRETE_POINTS, START_UOD, STOP_UOD, START_COLD, MID_COLD, END_COLD);
@@ -161,10 +219,52 @@ int InitializeSets (struct SSets **sets, int nsets, long npoints, double start_u
  *	}
  *	@endcode
  */
-double *MembershipFunction (int type, ...);
+fuzzy_t *MembershipFunction (int type, ...);
+
+/**
+ * 	Evaluates a membership function at a single point of the universe of discourse
+ * 	@param type	membership function type (TRIANGULAR, TRAPEZOIDAL, GAUSSIAN)
+ * 	@param params function parameters (x1, x2, x3 / x1, x2, x3, x4 / center, sigma)
+ * 	@param point position in the universe of discourse
+ *  @return membership degree, same formulas used by MembershipFunction ()
+ */
+double MembershipValue (int type, const double *params, double point);
+
+/**
+ * 	Membership degree of a crisp value in a fuzzy set
+ *	@param set fuzzy set (allocated with InitializeSets (), InitializeInterleavedSets () or InitializeAnalyticSets ())
+ * 	@param point position in the universe of discourse
+ *  @return the discretized value nearest to point for MEMBERSHIP_TABLE and MEMBERSHIP_INTERLEAVED sets,
+ *	or the exact value of the membership function for MEMBERSHIP_ANALYTIC sets
+ *  @note	Usage:
+ *	@code
+ *	double degree;
+ *
+ *	degree = MembershipDegree (&temperature[TEMP_WARM], 27.3);
+ *	@endcode
+ */
+double MembershipDegree (const struct SSets *set, double point);
+
+/**
+ * 	Membership degrees of a crisp value in all the sets of an interleaved variable
+ *	@param sets fuzzy sets allocated with InitializeInterleavedSets ()
+ * 	@param point position in the universe of discourse
+ *  @return pointer to the degree vector (indexed by set) of the discretization point nearest to point,
+ *	or NULL if the sets are not MEMBERSHIP_INTERLEAVED
+ *  @note	The vector points inside the sets table, it must not be released. Usage:
+ *	@code
+ *	const fuzzy_t *degrees;
+ *
+ *	degrees = MembershipVector (temperature, 27.3);
+ *
+ *	FuzzyIfVector1 (degrees, TEMP_COLD, dutycycle_control, CONTROL_MIN, MANDANI, &fuzzy_resp);
+ *	FuzzyIfVector1 (degrees, TEMP_WARM, dutycycle_control, CONTROL_MED, MANDANI, &fuzzy_resp);
+ *	@endcode
+ */
+const fuzzy_t *MembershipVector (const struct SSets *sets, double point);
 
 /**
- * 	Fuzzifies the membership functions
+ * 	Fuzzifies the membership functions (the set vector is filled in place, so it can be called again to retune a set)
  *	@param sets	fuzzy sets object pointer
  * 	@param type	membership function type (TRIANGULAR, TRAPEZOIDAL, GAUSSIAN)
  * 	@param npoints  number of discretization points
@@ -186,7 +286,9 @@ double *MembershipFunction (int type, ...);
  *	@param center center of the gaussian function
  * 	@param sigma standart deviation
  *  @return nothing
- *  @note	Usage:
+ *  @note	The support of the set is recorded too: sets->first and sets->last are the first and last discretization
+ *	points with non zero degree and no crisp value out of [sets->support_start, sets->support_stop] has a non zero
+ *	degree (the rule base uses it to skip the rules that cannot fire). Usage:
  *	@code
  *  // limit values for fuzzy memberships
  *  #define TEMP_COLD	0
@@ -242,7 +344,8 @@ void Fuzzification (struct SSets *sets, int type, ...);
  * 	@param npoints  number of discretization points
  * 	@param start_uod universe of discourse start value
  * 	@param stop_uod universe of discourse stop value
- *  @return vector index to the vector of discrete points
+ *  @return vector index to the vector of discrete points, clamped to [0, npoints - 1] (0 for NaN), same as
+ *	UniversePosDisc ()
  *  @note This function is a wrapper of the OpenFIS library. Usage:
  *	@code
  *	// discrete points (bigger this value is, more precise will be the output, but the performance (speed) will be decreased
@@ -276,7 +379,8 @@ long ConvPosDisc (double point, long npoints, double start_uod, double stop_uod)
  * 	@param npoints  number of discretization points
  * 	@param start_uod universe of discourse start value
  * 	@param stop_uod universe of discourse stop value
- *  @return a value (float point) of the universe of discourse
+ *  @return a value (float point) of the universe of discourse: start_uod + disc * (stop_uod - start_uod) / npoints,
+ *	same as UniverseDiscPos ()
  *  @note This function is a wrapper of the OpenFIS library. Usage:
  *	@code
  *	// discrete points (bigger this value is, more precise will be the output, but the performance (speed) will be decreased
@@ -304,13 +408,71 @@ long ConvPosDisc (double point, long npoints, double start_uod, double stop_uod)
  */
 double ConvDiscPos  (long int disc, long npoints, double start_uod, double stop_uod);
 
+/**
+ * 	Allocates a universe of discourse (InitializeSets () builds one per variable and shares it among its sets)
+ *	@param universe universe object pointer
+ * 	@param npoints  number of discretization points
+ * 	@param start_uod universe of discourse start value
+ * 	@param stop_uod universe of discourse stop value
+ *  @return TRUE if success or FALSE if it fails
+ *  @note	Usage:
+ *	@code
+ *	struct SUniverse *universe;
+ *
+ *	if (! InitializeUniverse (&universe, DISCRETE_PTS, START_UOD, STOP_UOD))
+ *		return 0;
+ *  .
+ *  .
+ *  .
+ *	FreeUniverse (universe);
+ *	@endcode
+ */
+int InitializeUniverse (struct SUniverse **universe, long npoints, double start_uod, double stop_uod);
+
+/**
+ * 	Releases a universe allocated with InitializeUniverse ()
+ *	@param universe universe object pointer
+ *  @return nothing
+ */
+void FreeUniverse (struct SUniverse *universe);
+
+/**
+ * 	change a position in the universe of discourse in a position of discretization (constant time)
+ *	@param universe universe of discourse of the variable
+ *	@param point position in the universe of discourse
+ *  @return vector index to the vector of discrete points, clamped to [0, npoints - 1] (0 for NaN)
+ *  @note	Usage:
+ *	@code
+ *	long pos;
+ *
+ *	pos = UniversePosDisc (temperature[TEMP_COLD].universe, 10.5);
+ *	@endcode
+ */
+long UniversePosDisc (const struct SUniverse *universe, double point);
+
+/**
+ * 	change a position of discretization in a position in the universe of discourse (constant time)
+ *	@param universe universe of discourse of the variable
+ *	@param disc position in the discrete vector
+ *  @return a value (float point) of the universe of discourse, start_uod + disc * step (where the tables are
+ *	sampled), same as ConvDiscPos ()
+ *  @note	Usage:
+ *	@code
+ *	double value;
+ *
+ *	value = UniverseDiscPos (dutycycle_control[0].universe, 300);
+ *	@endcode
+ */
+double UniverseDiscPos (const struct SUniverse *universe, long disc);
+
 /**
  * 	Singleton Set
  *	@param point position in the universe of discourse
  * 	@param npoints  number of discretization points
  * 	@param start_uod universe of discourse start value
  * 	@param stop_uod universe of discourse stop value
- *  @return vector containing the singleton set
+ *  @return vector containing the singleton set (1 at the point ConvPosDisc () gives, the nearest end point
+ *	for a point out of the universe)
  *  @note This function is a wrapper of the OpenFIS library. Usage:
  *	@code
  *	// discrete points (bigger this value is, more precise will be the output, but the performance (speed) will be decreased
@@ -324,7 +486,7 @@ double ConvDiscPos  (long int disc, long npoints, double start_uod, double stop_
  *  .
  *  int main (void)
  *	{
- *		double *value;
+ *		fuzzy_t *value;
  *  	.
  *  	.
  * 		.
@@ -336,7 +498,18 @@ double ConvDiscPos  (long int disc, long npoints, double start_uod, double stop_
  *	}
  *	@endcode
  */
-double *SigletonSet (double point, long npoints, double start_uod, double stop_uod);
+fuzzy_t *SigletonSet (double point, long npoints, double start_uod, double stop_uod);
+
+/**
+ * 	Singleton Set written in a caller allocated vector (same as SigletonSet (), without allocating memory)
+ *	@param set vector with npoints positions
+ *	@param point position in the universe of discourse
+ * 	@param npoints  number of discretization points
+ * 	@param start_uod universe of discourse start value
+ * 	@param stop_uod universe of discourse stop value
+ *  @return nothing
+ */
+void SingletonInto (fuzzy_t *set, double point, long npoints, double start_uod, double stop_uod);
 
 /**
  * 	Calculates the minimum between values
@@ -385,14 +558,24 @@ double Maximum (double value1, double value2);
  *	@code
  *	#define DISCRETE_PTS 10000
  *
- *	double *cut_set;
- *	double *temperature;
+ *	fuzzy_t *cut_set;
+ *	fuzzy_t *temperature;
  *  double alpha = 0.7;
  *
  *	cut_set = Cut (&temperature, DISCRETE_PTS, alpha, 0); // doesnt overwrite the input vector
  *
  *	@endcode
  */
-double *Cut (double **set, long npoints, double alpha, int flag);
+fuzzy_t *Cut (fuzzy_t **set, long npoints, double alpha, int flag);
+
+/**
+ * 	Cut operation written in a caller allocated vector (same as Cut (set, npoints, alpha, FALSE), without allocating memory)
+ *	@param set input vector
+ *	@param cut output vector (npoints positions, may be the input vector)
+ * 	@param npoints  number of discretization points
+ * 	@param alpha  cut threshold
+ *  @return nothing
+ */
+void CutInto (const fuzzy_t *set, fuzzy_t *cut, long npoints, double alpha);
 
 #endif
@@ -0,0 +1,266 @@
+/**
+ * @file
+ * @author  Andre Silva <andreluizeng@yahoo.com.br>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2012, Andre Luiz Vieira da Silva
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this software
+ *    must display the following acknowledgement:
+ *    This product includes software developed by the <organization>.
+ * 4. Neither the name of the <organization> nor the
+ *    names of its contributors may be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Andre Silva ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Andre Silva BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @section DESCRIPTION
+ *
+ */
+
+#ifndef __fixed_h__
+#define __fixed_h__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <stdint.h>
+
+#include "openfuzz.h"
+
+#pragma once
+
+#define Q15_ONE             32768	// membership degree 1.0 (degrees are unsigned Q15: 0 .. 32768)
+#define Q16_ONE             65536	// crisp values are signed Q16.16
+#define FIXED_MAX_POINTS    32767	// biggest number of discretization points of a fixed point variable
+
+// conversion of constants and sensor readings (the inference functions never use floating point)
+#define DOUBLE_TO_Q16(x)    ((int32_t) ((x) * 65536.0 + (((x) < 0) ? -0.5 : 0.5)))
+#define Q16_TO_DOUBLE(x)    ((double) (x) / 65536.0)
+
+/**
+ * 	Multiplication by a real constant in integer arithmetic: x * constant = (x * mult) >> shift
+ * 	@param mult constant scaled by 2^shift (between 2^31 and 2^32 - 1, the best precision for 32 bits)
+ * 	@param shift number of fractional bits of mult
+ */
+struct SFixedScale
+{
+      uint32_t mult;
+      int shift;
+};
+
+/**
+ * 	Fixed point fuzzy set struct (Q15 copy of a discretized SSets variable)
+ * 	@param value membership table in Q15 (Q15_ONE = 1.0)
+ * 	@param nsets number of sets
+ * 	@param npoints number of discretization points
+ * 	@param start_uod start of universe of discourse (Q16.16)
+ * 	@param stop_uod stop of universe of discourse (Q16.16)
+ * 	@param scale npoints / universe range: crisp offset (Q16.16) -> point index (Q16.16)
+ * 	@param step universe range / npoints: point index (Q16.16) -> crisp offset (Q16.16)
+ * 	@param first first discretization point with non zero degree
+ * 	@param last last discretization point with non zero degree (first > last if the set is empty)
+ * 	@param arena memory block holding all the sets of the variable (released by FreeFixedSets ())
+ */
+struct SFixedSets
+{
+      const uint16_t *value;
+      int nsets;
+      long npoints;
+      int32_t start_uod;
+      int32_t stop_uod;
+      struct SFixedScale scale;
+      struct SFixedScale step;
+      long first;
+      long last;
+      void *arena;
+};
+
+/**
+ * 	Fixed point inference context (Q15 aggregated output, the SInference of the fixed point pipeline)
+ * 	@param fuzzy_values aggregated rules in Q15
+ * 	@param npoints number of allocated positions
+ * 	@param first first point written since the last ClearFixedInference ()
+ * 	@param last last point written since the last ClearFixedInference () (first > last if nothing was written)
+ */
+struct SFixedInference
+{
+      uint16_t *fuzzy_values;
+      long npoints;
+      long first;
+      long last;
+};
+
+/**
+ * 	Converts the sets of a discretized variable into Q15 tables
+ * 	@param fixed fixed point sets object pointer (one per set, as InitializeSets ())
+ * 	@param sets fuzzified sets (MEMBERSHIP_TABLE or MEMBERSHIP_INTERLEAVED, at most FIXED_MAX_POINTS points)
+ *  @return TRUE if success or FALSE if it fails
+ *  @note The conversion is the only place where floating point is used: it can run once at start up, or on
+ *	the host, the tables (fixed[i].value, npoints values per set) being given to LoadFixedSets () on the
+ *	target. FixedDegree (), FixedIfInput1 (), FixedIfInput2 () and FixedDeFuzzy () use integer arithmetic
+ *	only and run on cores with no FPU. The universe must stay within the Q16.16 range (+-32767). Usage:
+ *	@code
+ *	struct SFixedSets *fixed_temperature;
+ *	struct SFixedSets *fixed_dutycycle;
+ *
+ *	InitializeFixedSets (&fixed_temperature, temperature);
+ *	InitializeFixedSets (&fixed_dutycycle, dutycycle_control);
+ *	@endcode
+ */
+int InitializeFixedSets (struct SFixedSets **fixed, const struct SSets *sets);
+
+/**
+ * 	Builds the sets of a fixed point variable from precomputed Q15 tables (no floating point)
+ * 	@param fixed fixed point sets object pointer (one per set, as InitializeFixedSets ())
+ * 	@param tables membership tables in Q15, the npoints values of set 0, then set 1, ... (not copied: they must
+ *	outlive the sets, and can stay in flash)
+ * 	@param nsets number of sets
+ * 	@param npoints number of discretization points of each set (at most FIXED_MAX_POINTS)
+ * 	@param start_uod start of universe of discourse (Q16.16)
+ * 	@param stop_uod stop of universe of discourse (Q16.16)
+ *  @return TRUE if success or FALSE if it fails
+ *  @note For cores with no FPU: the tables are written on the host from the sets of InitializeFixedSets ()
+ *	(fixed[i].value), which gives the same sets from the same tables and universe. Usage:
+ *	@code
+ *	// generated on the host: 3 sets of 1000 points, universe 5 .. 45
+ *	static const uint16_t temperature_q15[3 * 1000] = { 32768, 32711, ... };
+ *
+ *	struct SFixedSets *fixed_temperature;
+ *
+ *	LoadFixedSets (&fixed_temperature, temperature_q15, 3, 1000, 5 * Q16_ONE, 45 * Q16_ONE);
+ *	@endcode
+ */
+int LoadFixedSets (struct SFixedSets **fixed, const uint16_t *tables, int nsets, long npoints, int32_t start_uod, int32_t stop_uod);
+
+/**
+ * 	Releases the sets allocated with InitializeFixedSets () or LoadFixedSets ()
+ * 	@param fixed fixed point sets object
+ *  @return nothing
+ */
+void FreeFixedSets (struct SFixedSets *fixed);
+
+/**
+ * 	Allocates a fixed point inference context
+ * 	@param inference inference context object pointer
+ * 	@param npoints number of discretization points of the biggest output set
+ *  @return TRUE if success or FALSE if it fails
+ */
+int InitializeFixedInference (struct SFixedInference **inference, long npoints);
+
+/**
+ * 	Releases the inference context allocated with InitializeFixedInference ()
+ * 	@param inference inference context object
+ *  @return nothing
+ */
+void FreeFixedInference (struct SFixedInference *inference);
+
+/**
+ * 	Clears the aggregated output (only the window written since the last call)
+ * 	@param inference inference context object
+ *  @return nothing
+ */
+void ClearFixedInference (struct SFixedInference *inference);
+
+/**
+ * 	Membership degree of a crisp value in a fixed point set
+ * 	@param set fixed point set
+ * 	@param point crisp value (Q16.16)
+ *  @return degree in Q15 of the discretization point nearest to point (same rounding as UniversePosDisc ())
+ */
+uint16_t FixedDegree (const struct SFixedSets *set, int32_t point);
+
+/**
+ * 	Implication of one fired output membership aggregated (maximum) in the inference context
+ * 	@param inference inference context
+ * 	@param output output membership function
+ * 	@param alpha firing strength (Q15)
+ * 	@param method MANDANI: min (alpha, set[i]), LARSEN: alpha * set[i] (rounded), ZADEH: max (1 - alpha, min (alpha, set[i]))
+ *  @return nothing
+ */
+void FixedImplication (struct SFixedInference *inference, const struct SFixedSets *output, uint16_t alpha, int method);
+
+/**
+ * 	Rule base for 1 input, aggregated in the fixed point inference context (same as InferenceIfInput1 ())
+ * 	@param inference inference context
+ * 	@param input_set1 input set 1
+ * 	@param membership1 membership function of input set 1
+ * 	@param value1 crisp value of input 1 (Q16.16)
+ * 	@param output_set output set
+ * 	@param membership3 membership function of output set
+ * 	@param method implication method  (MANDANI, LARSEN, ZADEH)
+ *  @return nothing
+ */
+void FixedIfInput1 (struct SFixedInference *inference, const struct SFixedSets *input_set1, int membership1, int32_t value1,
+                    const struct SFixedSets *output_set, int membership3, int method);
+
+/**
+ * 	Rule base for 2 inputs, aggregated in the fixed point inference context (same as InferenceIfInput2 ())
+ * 	@param inference inference context
+ * 	@param input_set1 input set 1
+ * 	@param membership1 membership function of input set 1
+ * 	@param value1 crisp value of input 1 (Q16.16)
+ * 	@param op operator AND or OR
+ * 	@param input_set2 input set 2
+ * 	@param membership2 membership function of input set 2
+ * 	@param value2 crisp value of input 2 (Q16.16)
+ * 	@param output_set output set
+ * 	@param membership3 membership function of output set
+ * 	@param method implication method  (MANDANI, LARSEN, ZADEH)
+ *  @return nothing
+ */
+void FixedIfInput2 (struct SFixedInference *inference, const struct SFixedSets *input_set1, int membership1, int32_t value1, int op,
+                    const struct SFixedSets *input_set2, int membership2, int32_t value2,
+                    const struct SFixedSets *output_set, int membership3, int method);
+
+/**
+ * 	Defuzzifies the rules aggregated in the fixed point inference context
+ * 	@param inference inference context
+ * 	@param output_set output set
+ * 	@param method  COA, MOM, FOM, LOM or BOA (COA_ANALYTIC and BOA_ANALYTIC use COA and BOA)
+ *  @return crisp value (Q16.16), or 0 if no rule fired
+ *  @note COA accumulates blocks of 256 points in 32 bits (exact), folded into saturating 64 bit sums;
+ *	the crisp value takes a single division. Against the floating point engine on the same discretization
+ *	(1000 and 10000 points) and the same Q16.16 inputs, the result stays within: COA 1e-4 of the output
+ *	range for MANDANI and ZADEH, 1e-3 for LARSEN (each product is rounded to Q15, which weighs on weakly
+ *	fired rules); BOA one discretization point for MANDANI and ZADEH, 1e-3 of the output range for LARSEN
+ *	(the rounded products move the half area point where the aggregate is low); MOM, FOM and LOM the same
+ *	point unless two maxima are within one Q15 step (the tie is then resolved differently). A double input
+ *	closer than one Q16.16 step to the middle of two points can read the other point. Firing strengths
+ *	below 1 / 65536 round to 0, so a rule that fires less than that on its own gives 0 (nothing fired).
+ *	@code
+ *	ClearFixedInference (inference);
+ *
+ *	FixedIfInput1 (inference, fixed_temperature, TEMP_COLD, DOUBLE_TO_Q16 (temp_value), fixed_dutycycle, CONTROL_MIN, MANDANI);
+ *	FixedIfInput1 (inference, fixed_temperature, TEMP_WARM, DOUBLE_TO_Q16 (temp_value), fixed_dutycycle, CONTROL_MED, MANDANI);
+ *	FixedIfInput1 (inference, fixed_temperature, TEMP_HOT, DOUBLE_TO_Q16 (temp_value), fixed_dutycycle, CONTROL_MAX, MANDANI);
+ *
+ *	duty = FixedDeFuzzy (inference, fixed_dutycycle, COA);    // Q16.16
+ *	@endcode
+ */
+int32_t FixedDeFuzzy (const struct SFixedInference *inference, const struct SFixedSets *output_set, int method);
+
+#endif
@@ -0,0 +1,211 @@
+/**
+ * @file
+ * @author  Andre Silva <andreluizeng@yahoo.com.br>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2012, Andre Luiz Vieira da Silva
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this software
+ *    must display the following acknowledgement:
+ *    This product includes software developed by the <organization>.
+ * 4. Neither the name of the <organization> nor the
+ *    names of its contributors may be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Andre Silva ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Andre Silva BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @section DESCRIPTION
+ *
+ */
+
+#ifndef __kernels_h__
+#define __kernels_h__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#include "openfuzz.h"
+
+#pragma once
+
+#define KERNEL_SCALAR	0	// portable C loops
+#define KERNEL_SSE2		1	// x86 SSE2 (2 doubles per vector)
+#define KERNEL_AVX2		2	// x86 AVX2 + FMA (4 doubles per vector)
+
+/**
+ * 	Reduction of an aggregated vector (filled by ReductionKernel ())
+ * 	@param sum sum of the values
+ * 	@param moment sum of value * position
+ * 	@param max biggest value
+ * 	@param first_max first point with the biggest value
+ * 	@param last_max last point with the biggest value
+ * 	@param nmax number of points with the biggest value
+ * 	@param max_moment sum of the positions of the points with the biggest value
+ */
+struct SReduction
+{
+      double sum;
+      double moment;
+      double max;
+      long first_max;
+      long last_max;
+      long nmax;
+      double max_moment;
+};
+
+/**
+ * 	Returns the vector kernel set used by the library
+ *  @return KERNEL_SCALAR, KERNEL_SSE2 or KERNEL_AVX2
+ *  @note The best kernel set supported by the running CPU is detected on the first call (safe to
+ *	race from several threads, they all detect the same level)
+ */
+int KernelLevel (void);
+
+/**
+ * 	Forces a kernel set (mainly for benchmarking and comparing against the scalar reference)
+ * 	@param level KERNEL_SCALAR, KERNEL_SSE2 or KERNEL_AVX2
+ *  @return the level in use (lowered to the best one supported by the CPU)
+ *  @note Call it before starting the threads that run inferences, a level changed while they run
+ *	is picked up by each kernel call independently
+ */
+int SetKernelLevel (int level);
+
+/**
+ * 	Fills a membership vector, the coordinate of each point is computed from its index (start_uod + i * step)
+ *	@param values vector to be filled (npoints values)
+ * 	@param npoints  number of discretization points
+ * 	@param start_uod universe of discourse start value
+ * 	@param step distance between two discretization points
+ * 	@param type	membership function type (TRIANGULAR, TRAPEZOIDAL, GAUSSIAN)
+ * 	@param params function parameters (x1, x2, x3 / x1, x2, x3, x4 / center, sigma)
+ *  @return nothing
+ *  @note The SSE2 and AVX2 kernels compute GAUSSIAN with a polynomial exp () approximation
+ *	(Cody-Waite reduction to |r| <= ln(2)/2 and a degree 12 Taylor polynomial). Its relative
+ *	error is below 5e-16 (about 2 ulp) for exponents in [-708, 0]; smaller exponents give 0.
+ *	The scalar kernel calls exp () from the C library. TRIANGULAR and TRAPEZOIDAL tables are the same on
+ *	every level (and the same as openfuzz::Tables, computed at compile time). With OPENFUZZ_FLOAT the
+ *	points are computed in double and rounded once when stored.
+ *	Usage:
+ *	@code
+ *	double params[3] = {START_COLD, MID_COLD, END_COLD};
+ *
+ *	MembershipKernel (temperature[TEMP_COLD].value, DISCRETE_PTS, START_UOD, (STOP_UOD - START_UOD) / DISCRETE_PTS, TRIANGULAR, params);
+ *	@endcode
+ */
+void MembershipKernel (fuzzy_t *values, long npoints, double start_uod, double step, int type, const double *params);
+
+/**
+ * 	Clips a set at alpha and aggregates it in place: fuzzy_values[i] = max (fuzzy_values[i], min (alpha, set[i]))
+ *	@param fuzzy_values aggregated rules (updated in place)
+ *	@param set output set vector
+ * 	@param npoints  number of discretization points
+ * 	@param alpha  rule firing strength (cut threshold)
+ *  @return nothing
+ *  @note One pass and no temporary vector (same result as Cut () followed by the maximum of both vectors).
+ *	Nothing is done when alpha is 0. With OPENFUZZ_FLOAT alpha is rounded to float and the SIMD kernels
+ *	process 4 (SSE2) or 8 (AVX2) points per instruction. Usage:
+ *	@code
+ *	ClipMaxKernel (fuzzy_resp, dutycycle_control[CONTROL_MED].value, DISCRETE_PTS, 0.35);
+ *	@endcode
+ */
+void ClipMaxKernel (fuzzy_t *fuzzy_values, const fuzzy_t *set, long npoints, double alpha);
+
+/**
+ * 	Implication of a fired rule aggregated in place (maximum) for a singleton (crisp) input
+ *	@param fuzzy_values aggregated rules (updated in place)
+ *	@param set output set vector
+ * 	@param npoints  number of discretization points
+ * 	@param alpha  rule firing strength (membership degree of the crisp input)
+ * 	@param method MANDANI: min (alpha, set[i]), LARSEN: alpha * set[i], ZADEH: max (1 - alpha, min (alpha, set[i]))
+ *  @return nothing
+ *  @note The singleton input set is all zeros but one point, so the implication only needs the firing
+ *	strength: one pass over the output set instead of npoints1 x npoints2 operations. With OPENFUZZ_FLOAT
+ *	LARSEN splits alpha in two floats (alpha rounded to float and the rest), set[i] * alpha is
+ *	set[i] * high + set[i] * rest: the error of alpha rounded to float does not scale the whole set.
+ */
+void ImplicationKernel (fuzzy_t *fuzzy_values, const fuzzy_t *set, long npoints, double alpha, int method);
+
+/**
+ * 	Applies a fuzzy operator element by element: values[i] = min (values[i], operand[i]) for AND,
+ *	max (values[i], operand[i]) for OR
+ *	@param values first operand and result (n values)
+ *	@param operand second operand (n values)
+ *	@param n number of values
+ * 	@param op operator AND or OR
+ *  @return nothing
+ */
+void OperatorKernel (double *values, const double *operand, long n, int op);
+
+/**
+ * 	Membership degrees of one set at n crisp points (MembershipDegree () of each point)
+ *	@param degrees membership degrees (n values)
+ *	@param set fuzzy set (any membership mode)
+ *	@param points crisp values
+ *	@param n number of crisp values
+ *  @return nothing
+ *  @note The AVX2 kernel gathers the table and interleaved degrees 4 points at a time with the rounding of
+ *	UniversePosDisc () (single precision tables are gathered as float and widened). MEMBERSHIP_ANALYTIC sets use the SIMD membership shapes of MembershipKernel (), which
+ *	multiply by the inverse of the edge widths and may differ from MembershipValue () by 1 or 2 ulp.
+ */
+void DegreeKernel (double *degrees, const struct SSets *set, const double *points, long n);
+
+/**
+ * 	Reduces an aggregated vector in one pass: sums for COA and maxima for MOM, FOM and LOM
+ *	@param fuzzy_values aggregated rules
+ * 	@param npoints  number of discretization points
+ *	@param reduction sums and maxima of the vector
+ *  @return nothing
+ *  @note The vector is reduced in blocks of 256 points (the SIMD lanes keep their own maximum and its
+ *	first/last index), and the block sums are added pairwise, so the rounding error of sum and moment
+ *	grows with log (npoints) and not with npoints. Single precision vectors are widened to double when
+ *	loaded, the sums are always double. Positions are point indexes. Every level adds the points of a
+ *	block in four lanes, (0 + 1) + (2 + 3) and the rest in order, with no FMA, so the sums are the same
+ *	on every level (as long as the compiler does not contract the scalar loop: -ffp-contract=off or a
+ *	strict -std=c.. / -std=c++.. mode).
+ */
+void ReductionKernel (const fuzzy_t *fuzzy_values, long npoints, struct SReduction *reduction);
+
+/**
+ * 	Aggregates (membership, alpha) pairs of an output set and accumulates the COA sums in the same pass
+ *	@param fuzzy_values aggregated rules (written if not NULL)
+ *	@param output_set output set (allocated with InitializeSets ())
+ *	@param memberships membership function of each pair
+ *	@param alphas firing strength of each pair
+ *	@param n number of pairs
+ * 	@param method implication method (MANDANI, LARSEN, ZADEH)
+ *	@param sum sum of the aggregated values
+ *	@param moment sum of aggregated value * point index
+ *  @return nothing
+ *  @note The output universe is processed in blocks of 256 points: every pair is clipped and aggregated into
+ *	a block that stays in the L1 cache and the block is reduced (pairwise, as in ReductionKernel ()) before the
+ *	next one is started, so the aggregate is never stored when fuzzy_values is NULL. For MANDANI and LARSEN
+ *	only the union of the supports of the fired memberships is processed (the rest of fuzzy_values is set to 0).
+ */
+void AggregationKernel (fuzzy_t *fuzzy_values, const struct SSets *output_set, const int *memberships, const double *alphas, int n,
+                        int method, double *sum, double *moment);
+
+#endif
@@ -14,6 +14,53 @@
 #define FALSE           0
 #define TRUE            1
 
+// element type of the membership vectors and of the aggregated output: double by default, build every
+// file with -DOPENFUZZ_FLOAT to store them in single precision (half the memory traffic, twice the
+// SIMD lanes). Crisp values, membership parameters, rule strengths and sums stay double.
+#ifdef OPENFUZZ_FLOAT
+typedef float fuzzy_t;
+#else
+typedef double fuzzy_t;
+#endif
+
+/*
+ *	Sharing between threads
+ *
+ *	Model (read only once built, any number of threads may use it concurrently without locks):
+ *	- SSets / SUniverse after InitializeSets () and Fuzzification ()
+ *	- SRuleBase after CompileRuleBase () (through EvaluateState () / InferBatchState ())
+ *	- SSurface after CompileSurface ()
+ *
+ *	Per inference state (one per thread, never shared):
+ *	- SInference (InferenceIfInput1 (), InferenceIfInput2 (), InferenceDeFuzzy ())
+ *	- SRuleState (InitializeRuleState ()), SEnvelope, and the vectors written by FuzzyIfInput1 (),
+ *	  FuzzyIfVector1 (), DeFuzzyAggregate () ...
+ *
+ *	Evaluate () and InferBatch () use the state owned by the rule base, so they belong to a single
+ *	thread at a time, as does an SExecutor. Building or changing a model (Fuzzification (), SetRule (),
+ *	CompileRuleBase () ...) must not overlap with inferences reading it.
+ */
+
+/**
+ * 	Universe of discourse struct (built once per variable and shared by all of its sets)
+ * 	@param npoints number of discretization points
+ * 	@param start_uod start of universe of discourse
+ * 	@param stop_uod stop of universe of discourse
+ * 	@param step distance between two discretization points
+ * 	@param scale discretization points per unit of the universe of discourse
+ *  @note Point i is at start_uod + i * step: the first point is start_uod and the last one stop_uod - step.
+ *	The tables are sampled there, UniverseDiscPos () returns that position and UniversePosDisc () the
+ *	nearest point (a crisp value from stop_uod - step / 2 on reads the last point).
+ */
+struct SUniverse
+{
+      long npoints;		// number of discretization points
+      double start_uod;  // uod = universe of discourse
+      double stop_uod;
+      double step;		// (stop_uod - start_uod) / npoints
+      double scale;		// npoints / (stop_uod - start_uod)
+};
+
 /**
  * 	Fuzzy set struct
  * 	@param value membership pointer
@@ -21,19 +68,47 @@
  * 	@param npoints number of discretization points
  * 	@param start_uod start of universe of discourse
  * 	@param stop_uod stop of universe of discourse
+ * 	@param universe universe of discourse shared by all the sets of the variable
+ * 	@param mode MEMBERSHIP_TABLE (one vector per set), MEMBERSHIP_INTERLEAVED (one [point][term] table
+ *	per variable) or MEMBERSHIP_ANALYTIC (closed form, no vector)
+ * 	@param type membership function type given to Fuzzification ()
+ * 	@param params membership function parameters given to Fuzzification ()
+ * 	@param arena memory block holding all the sets of the variable (released by FreeSets ())
+ * 	@param degrees [point][term] table shared by the sets of a MEMBERSHIP_INTERLEAVED variable
+ * 	@param stride number of values in a row of the degrees table
+ * 	@param term index of the set inside its variable
  */
-extern struct SSets
+struct SSets
 {
-      double *value;	// membership value
+      fuzzy_t *value;	// membership value
       int nsets;			// number of sets
       long npoints;		// number of discretization points
       double start_uod;  // uod = universe of discourse
       double stop_uod;
-} InfoSet;
+      struct SUniverse *universe;	// shared discrete <-> uod conversion
+      int mode;			// MEMBERSHIP_TABLE, MEMBERSHIP_INTERLEAVED or MEMBERSHIP_ANALYTIC
+      int type;			// TRIANGULAR, TRAPEZOIDAL or GAUSSIAN
+      double params[4];	// x1..x3 / x1..x4 / center, sigma
+      void *arena;		// single allocation shared by the sets of the variable
+      fuzzy_t *degrees;	// interleaved table: degrees[point * stride + term]
+      int stride;
+      int term;
+      long first;		// first and last discretization point with non zero degree
+      long last;
+      double support_start;	// crisp values out of [support_start, support_stop] have degree 0
+      double support_stop;
+      unsigned int revision;	// counts the Fuzzification () calls (a rule base rebuilds its support index when it changes)
+};
 
 #include "defuzzy.h"
 #include "fisutils.h"
 #include "implications.h"
+#include "kernels.h"
+#include "inference.h"
+#include "rulebase.h"
+#include "surface.h"
+#include "executor.h"
+#include "fixed.h"
 
 
 #endif
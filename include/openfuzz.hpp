@@ -0,0 +1,653 @@
+/**
+ * @file
+ * @author  Andre Silva <andreluizeng@yahoo.com.br>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2012, Andre Luiz Vieira da Silva
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this software
+ *    must display the following acknowledgement:
+ *    This product includes software developed by the <organization>.
+ * 4. Neither the name of the <organization> nor the
+ *    names of its contributors may be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Andre Silva ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Andre Silva BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @section DESCRIPTION
+ *
+ */
+
+#ifndef __openfuzz_hpp__
+#define __openfuzz_hpp__
+
+#include <cmath>
+#include <tuple>
+
+#include "openfuzz.h"
+
+#pragma once
+
+#if __cplusplus < 201402L
+#error "openfuzz.hpp needs C++14 (the membership tables are computed by constexpr constructors)"
+#endif
+
+// Header only C++ (C++14) layer: the membership shapes, the number of inputs and terms, the rules, the
+// t-norm, the implication and the defuzzifier are template parameters, so one inference is expanded and
+// inlined by the compiler (no va_arg decoding, no function pointers, no virtual calls). Input degrees are
+// exact (as MEMBERSHIP_ANALYTIC sets), the output is discretized in Points points (as InitializeSets ()).
+// Tables and FuzzySystem can be constexpr objects: their membership tables are then computed by the
+// compiler and stored in read only memory (.rodata / flash), with nothing to initialize or free.
+
+namespace openfuzz
+{
+
+//-------------------------------------------------------------------------------------------------
+// membership shapes (same formulas as MembershipValue ())
+
+/**
+ * 	Triangular membership function
+ * 	@param x1 start of the support
+ * 	@param x2 peak
+ * 	@param x3 end of the support
+ */
+struct Triangle
+{
+    static constexpr int type = TRIANGULAR;
+
+    double x1;
+    double x2;
+    double x3;
+    double inv_rise;
+    double inv_fall;
+
+    constexpr Triangle (double a, double b, double c) : x1 (a), x2 (b), x3 (c),
+        inv_rise ((b > a) ? 1.0 / (b - a) : 0.0), inv_fall ((c > b) ? 1.0 / (c - b) : 0.0) {}
+
+    // degree of an input (as MembershipValue ())
+    constexpr double operator() (double x) const
+    {
+        return ((x >= x1) && (x < x2)) ? (x - x1) / (x2 - x1) :
+               ((x >= x2) && (x < x3)) ? (x3 - x) / (x3 - x2) : 0.0;
+    }
+
+    // degree of a point of a table (as MembershipKernel ())
+    constexpr double Grid (double x) const
+    {
+        return ((x < x1) || (x >= x3)) ? 0.0 : (x >= x2) ? (x3 - x) * inv_fall : (x - x1) * inv_rise;
+    }
+
+    // parameters of Fuzzification ()
+    constexpr void Parameters (double *params) const
+    {
+        params[0] = x1;
+        params[1] = x2;
+        params[2] = x3;
+    }
+};
+
+/**
+ * 	Trapezoidal membership function
+ * 	@param x1 start of the support
+ * 	@param x2 start of the core
+ * 	@param x3 end of the core
+ * 	@param x4 end of the support
+ */
+struct Trapezoid
+{
+    static constexpr int type = TRAPEZOIDAL;
+
+    double x1;
+    double x2;
+    double x3;
+    double x4;
+    double inv_rise;
+    double inv_fall;
+
+    constexpr Trapezoid (double a, double b, double c, double d) : x1 (a), x2 (b), x3 (c), x4 (d),
+        inv_rise ((b > a) ? 1.0 / (b - a) : 0.0), inv_fall ((d > c) ? 1.0 / (d - c) : 0.0) {}
+
+    constexpr double operator() (double x) const
+    {
+        return ((x >= x1) && (x < x2)) ? (x - x1) / (x2 - x1) :
+               ((x >= x2) && (x < x3)) ? 1.0 :
+               ((x >= x3) && (x < x4)) ? (x4 - x) / (x4 - x3) : 0.0;
+    }
+
+    constexpr double Grid (double x) const
+    {
+        return ((x < x1) || (x >= x4)) ? 0.0 : (x >= x3) ? (x4 - x) * inv_fall : (x < x2) ? (x - x1) * inv_rise : 1.0;
+    }
+
+    constexpr void Parameters (double *params) const
+    {
+        params[0] = x1;
+        params[1] = x2;
+        params[2] = x3;
+        params[3] = x4;
+    }
+};
+
+/**
+ * 	Gaussian membership function
+ * 	@param center center
+ * 	@param sigma width
+ *  @note std::exp () is not constexpr, so tables with gaussian terms can only be computed at run time
+ */
+struct Gaussian
+{
+    static constexpr int type = GAUSSIAN;
+
+    double center;
+    double sigma;
+    double inv_sigma2;
+
+    constexpr Gaussian (double c, double s) : center (c), sigma (s), inv_sigma2 (1.0 / (s * s)) {}
+
+    double operator() (double x) const { return std::exp (-((x - center) * (x - center)) / (sigma * sigma)); }
+
+    double Grid (double x) const { return std::exp (-((x - center) * (x - center)) * inv_sigma2); }
+
+    constexpr void Parameters (double *params) const
+    {
+        params[0] = center;
+        params[1] = sigma;
+    }
+};
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * 	Linguistic variable: universe of discourse and one shape per term (the term index is the position)
+ * 	@param start_uod start of universe of discourse
+ * 	@param stop_uod stop of universe of discourse
+ * 	@param terms membership shape of each term
+ */
+template <typename... Terms>
+struct Variable
+{
+    static const int nterms = sizeof... (Terms);
+
+    double start_uod;
+    double stop_uod;
+    std::tuple<Terms...> terms;
+
+    constexpr Variable (double start, double stop, const Terms &... shapes) : start_uod (start), stop_uod (stop), terms (shapes...) {}
+
+    template <int Term>
+    double Degree (double x) const { return std::get<Term> (terms) (x); }
+
+    template <int Term>
+    double Grid (double x) const { return std::get<Term> (terms).Grid (x); }
+};
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// t-norms (AND) with their dual t-conorms (OR)
+
+struct MinMax
+{
+    static double And (double a, double b) { return (a < b) ? a : b; }
+    static double Or (double a, double b) { return (a > b) ? a : b; }
+};
+
+struct ProductSum
+{
+    static double And (double a, double b) { return a * b; }
+    static double Or (double a, double b) { return a + b - a * b; }
+};
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// implications (same as ImplicationKernel ()): whole is true when a rule changes the points out of the
+// support of its output term
+
+struct Mandani
+{
+    static const bool whole = false;
+    static double Apply (double alpha, double mu) { return (mu < alpha) ? mu : alpha; }
+};
+
+struct Larsen
+{
+    static const bool whole = false;
+    static double Apply (double alpha, double mu) { return alpha * mu; }
+};
+
+struct Zadeh
+{
+    static const bool whole = true;
+    static double Apply (double alpha, double mu)
+    {
+        double value = (mu < alpha) ? mu : alpha;
+        return (value > 1.0 - alpha) ? value : 1.0 - alpha;
+    }
+};
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// defuzzifiers, fed point by point while the output is aggregated (no aggregate vector is stored)
+
+/**
+ * 	Centre of area (COA)
+ */
+struct Centroid
+{
+    double sum;
+    double moment;
+
+    Centroid () : sum (0), moment (0) {}
+
+    void Add (long i, double mu)
+    {
+        sum += mu;
+        moment += mu * (double) i;
+    }
+
+    double Value (double start_uod, double step) const
+    {
+        return (sum > 0) ? start_uod + (moment / sum) * step : 0.0;
+    }
+};
+
+/**
+ * 	Mean, first and last of maximum (MOM, FOM, LOM)
+ */
+struct Maxima
+{
+    double max;
+    long first;
+    long last;
+    long count;
+    double moment;
+
+    Maxima () : max (0), first (0), last (0), count (0), moment (0) {}
+
+    void Add (long i, double mu)
+    {
+        if (mu > max)
+        {
+            max = mu;
+            first = i;
+            count = 0;
+            moment = 0;
+        }
+
+        if ((mu == max) && (max > 0))
+        {
+            last = i;
+            count++;
+            moment += (double) i;
+        }
+    }
+};
+
+struct MeanOfMaximum : Maxima
+{
+    double Value (double start_uod, double step) const { return count ? start_uod + (moment / (double) count) * step : 0.0; }
+};
+
+struct FirstOfMaximum : Maxima
+{
+    double Value (double start_uod, double step) const { return count ? start_uod + (double) first * step : 0.0; }
+};
+
+struct LastOfMaximum : Maxima
+{
+    double Value (double start_uod, double step) const { return count ? start_uod + (double) last * step : 0.0; }
+};
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// rules: "if input Input is term Term", combined with And<...> / Or<...>, then the output is term Term
+
+template <int Input, int Term>
+struct Is
+{
+    template <typename TNorm, typename Inputs>
+    static double Strength (const Inputs &inputs, const double *x)
+    {
+        return std::get<Input> (inputs).template Degree<Term> (x[Input]);
+    }
+};
+
+template <typename... Antecedents>
+struct And;
+
+template <typename Antecedent>
+struct And<Antecedent>
+{
+    template <typename TNorm, typename Inputs>
+    static double Strength (const Inputs &inputs, const double *x) { return Antecedent::template Strength<TNorm> (inputs, x); }
+};
+
+template <typename Antecedent, typename... Rest>
+struct And<Antecedent, Rest...>
+{
+    template <typename TNorm, typename Inputs>
+    static double Strength (const Inputs &inputs, const double *x)
+    {
+        return TNorm::And (Antecedent::template Strength<TNorm> (inputs, x), And<Rest...>::template Strength<TNorm> (inputs, x));
+    }
+};
+
+template <typename... Antecedents>
+struct Or;
+
+template <typename Antecedent>
+struct Or<Antecedent>
+{
+    template <typename TNorm, typename Inputs>
+    static double Strength (const Inputs &inputs, const double *x) { return Antecedent::template Strength<TNorm> (inputs, x); }
+};
+
+template <typename Antecedent, typename... Rest>
+struct Or<Antecedent, Rest...>
+{
+    template <typename TNorm, typename Inputs>
+    static double Strength (const Inputs &inputs, const double *x)
+    {
+        return TNorm::Or (Antecedent::template Strength<TNorm> (inputs, x), Or<Rest...>::template Strength<TNorm> (inputs, x));
+    }
+};
+
+template <typename Antecedent, int Term>
+struct Rule
+{
+    typedef Antecedent antecedent;
+    static const int term = Term;
+};
+
+template <typename... List>
+struct Rules;
+
+template <>
+struct Rules<>
+{
+    static const int nrules = 0;
+
+    template <typename TNorm, typename Inputs>
+    static void Strengths (double *, const Inputs &, const double *) {}
+
+    static void Window (const double *, const struct SSets *, long *, long *) {}
+
+    template <typename Implication, typename Table>
+    static double Aggregate (const double *, const Table &, long) { return 0; }
+};
+
+template <typename First, typename... Rest>
+struct Rules<First, Rest...>
+{
+    static const int nrules = 1 + sizeof... (Rest);
+
+    // firing strength of each rule
+    template <typename TNorm, typename Inputs>
+    static void Strengths (double *alphas, const Inputs &inputs, const double *x)
+    {
+        alphas[0] = First::antecedent::template Strength<TNorm> (inputs, x);
+        Rules<Rest...>::template Strengths<TNorm> (alphas + 1, inputs, x);
+    }
+
+    // union of the supports (first .. last point) of the output terms of the fired rules
+    static void Window (const double *alphas, const struct SSets *sets, long *first, long *last)
+    {
+        if (alphas[0] > 0)
+        {
+            if (sets[First::term].first < *first) *first = sets[First::term].first;
+            if (sets[First::term].last > *last) *last = sets[First::term].last;
+        }
+
+        Rules<Rest...>::Window (alphas + 1, sets, first, last);
+    }
+
+    // aggregated (maximum) output degree at point i
+    template <typename Implication, typename Table>
+    static double Aggregate (const double *alphas, const Table &table, long i)
+    {
+        double value = Implication::Apply (alphas[0], table[First::term][i]);
+        double rest = Rules<Rest...>::template Aggregate<Implication> (alphas + 1, table, i);
+
+        return (value > rest) ? value : rest;
+    }
+};
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// tables of the terms of a variable, one by one: the points start_uod + i * step of the shape (as
+// MembershipKernel ()) and the support of the table (as UpdateSupport ())
+
+template <int Term, int Count>
+struct TermTables
+{
+    template <typename Var, typename Sets>
+    static constexpr void Fill (const Var &variable, Sets &tables)
+    {
+        long i = 0;
+
+        struct SSets &set = tables.sets[Term];
+
+        set.type = std::get<Term> (variable.terms).type;
+        std::get<Term> (variable.terms).Parameters (set.params);
+
+        for (i = 0; i < set.npoints; i++)
+            tables.value[Term][i] = (fuzzy_t) std::get<Term> (variable.terms).Grid (set.start_uod + (double) i * tables.universe.step);
+
+        for (set.first = 0; set.first < set.npoints; set.first++)
+            if (tables.value[Term][set.first] != 0) break;
+
+        for (set.last = set.npoints - 1; set.last >= set.first; set.last--)
+            if (tables.value[Term][set.last] != 0) break;
+
+        if (set.first > set.last)
+        {
+            set.support_start = HUGE_VAL;
+            set.support_stop = -HUGE_VAL;
+        }
+        else
+        {
+            set.support_start = (set.first == 0) ? -HUGE_VAL : set.start_uod + ((double) set.first - 1.5) / tables.universe.scale;
+            set.support_stop = (set.last == set.npoints - 1) ? HUGE_VAL : set.start_uod + ((double) set.last + 1.5) / tables.universe.scale;
+        }
+
+        TermTables<Term + 1, Count>::Fill (variable, tables);
+    }
+};
+
+template <int Count>
+struct TermTables<Count, Count>
+{
+    template <typename Var, typename Sets>
+    static constexpr void Fill (const Var &, Sets &) {}
+};
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * 	MEMBERSHIP_TABLE sets of a variable, without heap: the same sets as InitializeSets () followed by one
+ * 	Fuzzification () per term, usable by the C functions that take const struct SSets *
+ * 	@param Var Variable type (triangles and trapezoids for a constexpr object)
+ * 	@param Points number of discretization points
+ *  @note A constexpr object is computed by the compiler and placed in read only memory, so the sets are
+ *	shared by every thread and process and never freed (FreeSets () must not be called on them). The
+ *	sets point into the object itself, so it can not be copied. Usage (the sample output variable):
+ *	@code
+ *	typedef openfuzz::Variable<openfuzz::Triangle, openfuzz::Triangle, openfuzz::Triangle> DutyCycle;
+ *
+ *	static constexpr openfuzz::Tables<DutyCycle, DISCRETE_PTS> dutycycle_tables (DutyCycle (0.0, 100.0,
+ *	                                                            openfuzz::Triangle (START_MIN, MID_MIN, END_MIN),
+ *	                                                            openfuzz::Triangle (START_MED, MID_MED, END_MED),
+ *	                                                            openfuzz::Triangle (START_MAX, MID_MAX, END_MAX)));
+ *
+ *	const struct SSets *dutycycle_control = dutycycle_tables.sets;
+ *	@endcode
+ */
+template <typename Var, long Points>
+struct Tables
+{
+    static const int nsets = Var::nterms;
+
+    alignas (64) fuzzy_t value[nsets][Points];
+    struct SUniverse universe;
+    struct SSets sets[nsets];
+
+    constexpr Tables (const Var &variable) : value {}, universe {}, sets {}
+    {
+        int i = 0;
+
+        universe.npoints = Points;
+        universe.start_uod = variable.start_uod;
+        universe.stop_uod = variable.stop_uod;
+        universe.step = (variable.stop_uod - variable.start_uod) / (double) Points;
+        universe.scale = (double) Points / (variable.stop_uod - variable.start_uod);
+
+        for (i = 0; i < nsets; i++)
+        {
+            sets[i].value = value[i];
+            sets[i].nsets = nsets;
+            sets[i].npoints = Points;
+            sets[i].start_uod = variable.start_uod;
+            sets[i].stop_uod = variable.stop_uod;
+            sets[i].universe = &universe;
+            sets[i].mode = MEMBERSHIP_TABLE;
+            sets[i].arena = NULL;
+            sets[i].degrees = NULL;
+            sets[i].stride = 1;
+            sets[i].term = i;
+            sets[i].revision = 0;
+        }
+
+        TermTables<0, nsets>::Fill (variable, *this);
+    }
+
+    Tables (const Tables &) = delete;
+    Tables &operator= (const Tables &) = delete;
+};
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * 	Fuzzy system specialized at compile time
+ * 	@param Inputs std::tuple of the input Variable types
+ * 	@param Output output Variable type
+ * 	@param RuleList Rules<Rule<antecedent, term>, ...>
+ * 	@param TNorm MinMax (min / max) or ProductSum (product / probabilistic sum)
+ * 	@param Implication Mandani, Larsen or Zadeh
+ * 	@param Defuzzifier Centroid, MeanOfMaximum, FirstOfMaximum or LastOfMaximum
+ * 	@param Points number of discretization points of the output
+ *  @note With MinMax and the C implications and defuzzifiers, Infer () gives the result of the C engine with
+ *	MEMBERSHIP_ANALYTIC input sets and an output set of Points points (within rounding). The output terms
+ *	are tabulated by the constructor (a Tables object inside the system, no heap), so a system is a static
+ *	object, constexpr when the output terms are triangles and trapezoids (tables in read only memory, no
+ *	startup cost). Infer () only visits the supports of the fired output terms (the whole universe for
+ *	Zadeh): with g++ -O2 it has no calls left, the strengths of the rules are straight-line code and the
+ *	aggregation and defuzzification are one loop over the output points. check_system (sample) compares
+ *	the sample controller with Evaluate (). Usage (the sample temperature controller):
+ *	@code
+ *	typedef openfuzz::Variable<openfuzz::Triangle, openfuzz::Triangle, openfuzz::Triangle> Temperature;
+ *	typedef openfuzz::Variable<openfuzz::Triangle, openfuzz::Triangle, openfuzz::Triangle> DutyCycle;
+ *
+ *	typedef openfuzz::Rules<openfuzz::Rule<openfuzz::Is<0, TEMP_COLD>, CONTROL_MIN>,
+ *	                        openfuzz::Rule<openfuzz::Is<0, TEMP_WARM>, CONTROL_MED>,
+ *	                        openfuzz::Rule<openfuzz::Is<0, TEMP_HOT>, CONTROL_MAX> > ControllerRules;
+ *
+ *	typedef openfuzz::FuzzySystem<std::tuple<Temperature>, DutyCycle, ControllerRules,
+ *	                              openfuzz::MinMax, openfuzz::Mandani, openfuzz::Centroid, DISCRETE_PTS> Controller;
+ *
+ *	static constexpr Controller controller (std::make_tuple (Temperature (5.0, 45.0,
+ *	                                                                      openfuzz::Triangle (START_COLD, MID_COLD, END_COLD),
+ *	                                                                      openfuzz::Triangle (START_WARM, MID_WARM, END_WARM),
+ *	                                                                      openfuzz::Triangle (START_HOT, MID_HOT, END_HOT))),
+ *	                                        DutyCycle (0.0, 100.0,
+ *	                                                   openfuzz::Triangle (START_MIN, MID_MIN, END_MIN),
+ *	                                                   openfuzz::Triangle (START_MED, MID_MED, END_MED),
+ *	                                                   openfuzz::Triangle (START_MAX, MID_MAX, END_MAX)));
+ *
+ *	output_value = controller (temp_value);
+ *	@endcode
+ */
+template <typename Inputs, typename Output, typename RuleList, typename TNorm, typename Implication, typename Defuzzifier, long Points>
+class FuzzySystem
+{
+public:
+    static const int ninputs = std::tuple_size<Inputs>::value;
+    static const int nrules = RuleList::nrules;
+    static const long npoints = Points;
+
+    constexpr FuzzySystem (const Inputs &inputs, const Output &output) : inputs_ (inputs), output_ (output) {}
+
+    /**
+     * 	Crisp output of the system
+     * 	@param x crisp value of each input (ninputs values)
+     *  @return crisp value, or 0 if no rule fired
+     */
+    double Infer (const double *x) const
+    {
+        long i;
+        long first;
+        long last;
+        double alphas[nrules];
+
+        Defuzzifier defuzzifier;
+
+        RuleList::template Strengths<TNorm> (alphas, inputs_, x);
+
+        // window of the points that can be non zero (the whole universe with ZADEH)
+        first = 0;
+        last = Points - 1;
+
+        if (! Implication::whole)
+        {
+            first = Points;
+            last = -1;
+
+            RuleList::Window (alphas, output_.sets, &first, &last);
+            if (first > last) return 0;
+        }
+
+        for (i = first; i <= last; i++)
+            defuzzifier.Add (i, RuleList::template Aggregate<Implication> (alphas, output_.value, i));
+
+        return defuzzifier.Value (output_.universe.start_uod, output_.universe.step);
+    }
+
+    /**
+     * 	Crisp output of the system, one argument per input
+     */
+    template <typename... X>
+    double operator() (X... x) const
+    {
+        static_assert (sizeof... (X) == ninputs, "one crisp value per input");
+
+        const double values[] = { (double) x... };
+
+        return Infer (values);
+    }
+
+private:
+    Inputs inputs_;
+    Tables<Output, Points> output_;
+};
+//-------------------------------------------------------------------------------------------------
+
+}
+
+#endif
@@ -37,7 +37,7 @@
  *
  */
 
-#ifndef __defuzzy_h__
+ #ifndef __defuzzy_h__
 #define __defuzzy_h__
 
 #include <stdio.h>
@@ -54,14 +54,36 @@
 #define MOM 1 // Mean of Maxima
 #define FOM 2 // First Of Maximum
 #define LOM 3 // Last Of Maximum
+#define BOA 4 // Bisector Of Area
+#define COA_ANALYTIC 5 // Center of Area of the exact (not discretized) output
+#define BOA_ANALYTIC 6 // Bisector Of Area of the exact (not discretized) output
+
+/**
+ * 	Envelope workspace struct (vertex buffers reused by DeFuzzyEnvelope ())
+ * 	@param x vertex positions of the two merge buffers
+ * 	@param y vertex values of the two merge buffers
+ * 	@param capacity number of vertices each buffer can hold
+ * 	@param runs first vertex of each partial envelope (nruns + 1 entries)
+ * 	@param runs_capacity number of entries runs can hold
+ */
+struct SEnvelope
+{
+      double *x[2];
+      double *y[2];
+      long capacity[2];
+      long *runs;
+      int runs_capacity;
+};
 
 /**
  * 	Defuzzification Function
  * 	@param fuzzy_values vector with values of combined rules
  * 	@param output_set output set
- * 	@param method  currently this lib supports: COA, MOM, FOM and LOM
- *  	@return crisp value (control value)
- *  	@note	Usage:
+ * 	@param method  currently this lib supports: COA, MOM, FOM, LOM and BOA (COA_ANALYTIC and BOA_ANALYTIC
+ *	are computed as COA and BOA, the vector has no membership parameters)
+ *  @return crisp value (control value), or 0 if the vector is empty (no rule fired)
+ *  @note	All the methods come from one pass of ReductionKernel () over the vector. MOM is the mean position of
+ *	all the points with the biggest value, FOM and LOM the first and the last of them. Usage:
  *	@code
  *	struct SSets *output_set;		// allocated with Fuzzification ()
  *	char *fuzzy_rules_output; // allocated with malloc ()
@@ -72,6 +94,85 @@
  *	fis_response = DeFuzzy (fuzzy_rules_output, output_set, COA);
  *	@endcode
  */
-double DeFuzzy (double *fuzzy_values, struct SSets *output_set, int method);
+double DeFuzzy (const fuzzy_t *fuzzy_values, const struct SSets *output_set, int method);
+
+/**
+ * 	Defuzzification of a window of the vector (same as DeFuzzy (), the points out of the window must be 0)
+ * 	@param fuzzy_values vector with values of combined rules
+ * 	@param output_set output set
+ * 	@param method  COA, MOM, FOM, LOM or BOA
+ * 	@param first first point of the window
+ * 	@param last last point of the window (first > last for an empty window)
+ *  @return crisp value (control value), or 0 if the window is empty (no rule fired)
+ */
+double DeFuzzyRange (const fuzzy_t *fuzzy_values, const struct SSets *output_set, int method, long first, long last);
+
+/**
+ * 	Allocates an envelope workspace
+ * 	@param envelope envelope workspace pointer
+ *  @return TRUE if success or FALSE if it fails
+ */
+int InitializeEnvelope (struct SEnvelope **envelope);
+
+/**
+ * 	Releases an envelope workspace allocated with InitializeEnvelope ()
+ * 	@param envelope envelope workspace
+ *  @return nothing
+ */
+void FreeEnvelope (struct SEnvelope *envelope);
+
+/**
+ * 	Exact defuzzification of clipped (or scaled) TRIANGULAR and TRAPEZOIDAL output memberships
+ * 	@param envelope envelope workspace (NULL to use a temporary one)
+ * 	@param output_set output set (any membership mode, the parameters given to Fuzzification () are used)
+ * 	@param memberships membership function of each pair
+ * 	@param alphas firing strength of each pair
+ * 	@param n number of (membership, alpha) pairs
+ * 	@param implication implication method (MANDANI, LARSEN, ZADEH)
+ * 	@param method  COA_ANALYTIC (or COA) or BOA_ANALYTIC (or BOA)
+ *  @return crisp value (control value), or 0 if nothing fired
+ *  @note	The aggregated output max (implication (alpha, membership)) is piecewise linear: its upper envelope is
+ *	built from the breakpoints of each pair (merged two by two, O(n log n)) and its centroid or bisector is
+ *	integrated exactly over [start_uod, stop_uod], so the cost does not depend on the number of discretization
+ *	points and there is no discretization error. GAUSSIAN memberships are not supported. The workspace buffers
+ *	only grow, so a workspace reused between calls stops allocating. Usage:
+ *	@code
+ *	int memberships[2] = { CONTROL_MIN, CONTROL_MED };
+ *	double alphas[2];
+ *	double fis_response;
+ *
+ *	alphas[0] = MembershipDegree (&temperature[TEMP_COLD], temp_value);
+ *	alphas[1] = MembershipDegree (&temperature[TEMP_WARM], temp_value);
+ *
+ *	fis_response = DeFuzzyEnvelope (NULL, dutycycle_control, memberships, alphas, 2, MANDANI, COA_ANALYTIC);
+ *	@endcode
+ */
+double DeFuzzyEnvelope (struct SEnvelope *envelope, const struct SSets *output_set, const int *memberships, const double *alphas, int n,
+                        int implication, int method);
+
+/**
+ * 	COA of (membership, alpha) pairs aggregated and reduced in one pass, without a separate defuzzification sweep
+ * 	@param fuzzy_values vector for the aggregated rules (NULL if the aggregate is not needed)
+ * 	@param output_set output set (allocated with InitializeSets ())
+ * 	@param memberships membership function of each pair
+ * 	@param alphas firing strength of each pair
+ * 	@param n number of (membership, alpha) pairs
+ * 	@param implication implication method (MANDANI, LARSEN, ZADEH)
+ *  @return crisp value (same as DeFuzzy (..., COA) of the aggregated pairs), or 0 if nothing fired
+ *  @note	See AggregationKernel (): each block of the output universe is aggregated and reduced while it is
+ *	in the L1 cache, so the aggregate makes no round trip through memory. Usage:
+ *	@code
+ *	int memberships[2] = { CONTROL_MIN, CONTROL_MED };
+ *	double alphas[2];
+ *	double fis_response;
+ *
+ *	alphas[0] = MembershipDegree (&temperature[TEMP_COLD], temp_value);
+ *	alphas[1] = MembershipDegree (&temperature[TEMP_WARM], temp_value);
+ *
+ *	fis_response = DeFuzzyAggregate (NULL, dutycycle_control, memberships, alphas, 2, MANDANI);
+ *	@endcode
+ */
+double DeFuzzyAggregate (fuzzy_t *fuzzy_values, const struct SSets *output_set, const int *memberships, const double *alphas, int n,
+                         int implication);
 
 #endif
@@ -0,0 +1,197 @@
+/**
+ * @file
+ * @author  Andre Silva <andreluizeng@yahoo.com.br>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2012, Andre Luiz Vieira da Silva
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this software
+ *    must display the following acknowledgement:
+ *    This product includes software developed by the <organization>.
+ * 4. Neither the name of the <organization> nor the
+ *    names of its contributors may be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Andre Silva ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Andre Silva BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @section DESCRIPTION
+ *
+ */
+
+#ifndef __executor_h__
+#define __executor_h__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "openfuzz.h"
+
+#pragma once
+
+#define EXECUTOR_CHUNK	(BATCH_SAMPLES * 16)	// samples per unit of work (split and stolen as a whole)
+
+/**
+ * 	Counters of one worker thread (since InitializeExecutor () or ResetExecutorCounters ())
+ * 	@param samples samples evaluated
+ * 	@param chunks chunks evaluated
+ * 	@param steals successful steals from other workers
+ * 	@param stolen chunks taken by those steals
+ * 	@param busy seconds spent evaluating chunks
+ */
+struct SWorkerCounters
+{
+      long samples;
+      long chunks;
+      long steals;
+      long stolen;
+      double busy;
+};
+
+/**
+ * 	Worker thread struct
+ * 	@param executor executor the worker belongs to
+ * 	@param id worker index
+ * 	@param cpu cpu the worker is pinned to (-1 if not pinned)
+ * 	@param thread thread handle
+ * 	@param state per inference state of the worker (the rule base is shared)
+ * 	@param columns input and output column pointers of the chunk being evaluated
+ * 	@param lock protects next and end (the owner takes chunks from next, thieves from end)
+ * 	@param next first chunk of the worker still to be evaluated
+ * 	@param end one past the last chunk of the worker
+ * 	@param counters counters of the worker
+ */
+struct SWorker
+{
+      struct SExecutor *executor;
+      int id;
+      int cpu;
+      pthread_t thread;
+      struct SRuleState *state;
+      double **columns;
+
+      pthread_mutex_t lock;
+      long next;
+      long end;
+
+      struct SWorkerCounters counters;
+};
+
+/**
+ * 	Batch executor struct (thread pool running InferBatchState () over chunks of a batch)
+ * 	@param rules rule base shared by the workers (read only)
+ * 	@param nthreads number of worker threads
+ * 	@param workers worker threads
+ * 	@param lock protects job, running and quit
+ * 	@param start signalled when a job is posted (or quit is set)
+ * 	@param done signalled when the last worker finishes a job
+ * 	@param job number of the current job
+ * 	@param running workers still on the current job
+ * 	@param quit TRUE when the workers must exit
+ * 	@param inputs input columns of the current job
+ * 	@param outputs output columns of the current job
+ * 	@param nsamples number of samples of the current job
+ */
+struct SExecutor
+{
+      const struct SRuleBase *rules;
+      int nthreads;
+      struct SWorker *workers;
+
+      pthread_mutex_t lock;
+      pthread_cond_t start;
+      pthread_cond_t done;
+      unsigned long job;
+      int running;
+      int quit;
+
+      double * const *inputs;
+      double * const *outputs;
+      long nsamples;
+};
+
+/**
+ * 	Starts a pool of worker threads for a compiled rule base
+ * 	@param executor executor object pointer
+ * 	@param rules rule base object (compiled, must not be compiled again while the executor exists)
+ * 	@param nthreads number of worker threads (0 for one per online cpu)
+ * 	@param pin TRUE to pin worker k to cpu k (modulo the number of cpus, Linux only)
+ *  @return TRUE if success or FALSE if it fails
+ *  @note Each worker owns a state (InitializeRuleState ()), the rule base and its fuzzy sets are shared read
+ *	only. Usage:
+ *	@code
+ *	struct SExecutor *executor;
+ *	double *columns[2] = { temperatures, humidities };
+ *	double *results[1] = { duty_cycles };
+ *
+ *	if (! InitializeExecutor (&executor, rules, 0, TRUE))
+ *		return 0;
+ *
+ *	ExecuteBatch (executor, columns, results, nsamples);
+ *	ReportExecutor (executor);
+ *
+ *	FreeExecutor (executor);
+ *	@endcode
+ */
+int InitializeExecutor (struct SExecutor **executor, const struct SRuleBase *rules, int nthreads, int pin);
+
+/**
+ * 	Stops the worker threads and releases an executor allocated with InitializeExecutor ()
+ * 	@param executor executor object
+ *  @return nothing
+ */
+void FreeExecutor (struct SExecutor *executor);
+
+/**
+ * 	Evaluates a batch with the worker threads (same results as InferBatch ())
+ * 	@param executor executor object
+ * 	@param inputs column of each input variable, inputs[input][sample]
+ * 	@param outputs column of each output variable, outputs[output][sample]
+ * 	@param nsamples number of samples
+ *  @return TRUE if success or FALSE if it fails
+ *  @note The batch is cut in chunks of EXECUTOR_CHUNK samples and each worker gets a contiguous range of
+ *	them. A worker takes chunks from the front of its range; when it runs out it steals the back half of
+ *	the range of another worker, so faster workers (or workers on idle cores) end up doing more chunks.
+ *	The call returns when the whole batch is evaluated. Only one thread may call it at a time.
+ */
+int ExecuteBatch (struct SExecutor *executor, double * const *inputs, double * const *outputs, long nsamples);
+
+/**
+ * 	Prints the counters of each worker thread
+ * 	@param executor executor object
+ *  @return nothing
+ */
+void ReportExecutor (const struct SExecutor *executor);
+
+/**
+ * 	Clears the counters of each worker thread
+ * 	@param executor executor object
+ *  @return nothing
+ */
+void ResetExecutorCounters (struct SExecutor *executor);
+
+#endif
@@ -55,6 +55,7 @@
 #define MANDANI         0
 #define ZADEH           1
 #define LARSEN          2
+#define TSK             3	// Takagi-Sugeno-Kang, only for rule bases (consequents set with SetSugenoOutput ())
 
 #define AND             0
 #define OR              1
@@ -67,48 +68,56 @@
 // npoints2				= number of discretization points of output membership function
 // method				= implication method -> MANDANI, LARSEN, ZADEH
 /**
- * 	Allocates memory for Fuzzy Sets
- * 	@param sets fuzzy sets object pointer
- * 	@param nsets number of sets
- * 	@param npoints  number of discretization points
- * 	@param start_uod universe of discourse start value
- * 	@param stop_uod universe of discourse stop value
- * 	@param value  initialization value (normally 0 or NULL)
- *  @return TRUE if success or FALSE if it fails
- *  @note	Usage:
+ * 	Implication of a singleton (crisp) input
+ * 	@param singleton_input_set singleton set of input membership function (SigletonSet ())
+ * 	@param input_set input membership function
+ * 	@param output_set output membership function
+ * 	@param npoints1 number of discretization points of input membership function
+ * 	@param npoints2 number of discretization points of output membership function
+ * 	@param method implication method -> MANDANI, LARSEN, ZADEH
+ *  @return vector (npoints2 positions) with the implied output set, or NULL if it fails
+ *  @note The firing degree is read at the singleton position and the output set is transformed in one
+ *	pass (see ImplicationKernel ()). Usage:
  *	@code
- *	// discrete points (bigger this value is, more precise will be the output, but the performance (speed) will be decreased
- *	#define DISCRETE_PTS 10000
+ *	fuzzy_t *singleton;
+ *	fuzzy_t *implied;
  *
- *	// 3 memebership function for this set
- *	#define NSETS 3
- *
- *	// must be float point
- *	#define START_UOD 0.0
- *	#define STOP_UOD  100.0
- *  .
- *  .
- *  .
- *  int main (void)
- *	{
- *  	struct SSets *temperature;
- *  	int ret;
- *
- *		ret = InitializeSets (&temperature, NSETS, DISCRETE_PTS, START_UOD, STOP_UOD, 0.0);
- *		if (! ret)
- *		{
- *	 		printf ("\nError Initializing sets\n");
- *			return 0;
- *		}
- * 		.
- * 		.
- *		return 0;
- *	}
+ *	singleton = SigletonSet (27.3, DISCRETE_PTS, START_UOD, STOP_UOD);
+ *	implied = ImplicationSet (singleton, temperature[TEMP_WARM].value, dutycycle_control[CONTROL_MED].value,
+ *					DISCRETE_PTS, DISCRETE_PTS, LARSEN);
  *	@endcode
  */
-double *ImplicationSet (double *singleton_input_set, double *input_set, double *output_set, long npoints1, long npoints2, int method);
+fuzzy_t *ImplicationSet (fuzzy_t *singleton_input_set, fuzzy_t *input_set, fuzzy_t *output_set, long npoints1, long npoints2, int method);
+
+/**
+ * 	Checks the implication method given to a function out of a rule base
+ * 	@param method implication method
+ * 	@param function name of the calling function (for the error message)
+ *  @return TRUE for MANDANI, LARSEN and ZADEH, FALSE (with an error message) for TSK or an unknown method
+ *  @note TSK rules have crisp consequents and no output set to imply: TSK is only valid in a rule base
+ *	(InitializeRuleBase ()). The ImplicationSet (), FuzzyIf*, InferenceIf* and FixedIf* functions reject it
+ *	instead of running the ZADEH arithmetic.
+ */
+int CheckImplication (int method, const char *function);
+
+/**
+ * 	Implication written in a caller allocated vector (same as ImplicationSet (), without allocating memory)
+ * 	@param implication output vector (npoints2 positions)
+ * 	@param singleton_input_set singleton set of input membership function
+ * 	@param input_set input membership function
+ * 	@param output_set output membership function
+ * 	@param npoints1 number of discretization points of input membership function
+ * 	@param npoints2 number of discretization points of output membership function
+ * 	@param method implication method -> MANDANI, LARSEN, ZADEH
+ *  @return nothing
+ */
+void ImplicationInto (fuzzy_t *implication, const fuzzy_t *singleton_input_set, const fuzzy_t *input_set, const fuzzy_t *output_set,
+                        long npoints1, long npoints2, int method);
 
-//-------------------------------------------------------------------------------------------------//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+// The FuzzyIf* functions aggregate into a caller owned vector: give each thread its own vector (or
+// use InferenceIfInput1 () / InferenceIfInput2 () with one SInference per thread), the sets are only read.
+//-------------------------------------------------------------------------------------------------
 // Rule base for 1 inputs
 // input_set1	= input set 1
 // membership1	= membership function of input set 1
@@ -117,10 +126,10 @@ double *ImplicationSet (double *singleton_input_set, double *input_set, double *
 // membership3	= membermship function of input set 3
 // method		= implication method  (MANDANI, LARSEN, ZADEH)
 // fuzzy_values	= array with implicated values
-void  FuzzyIfInput1 (	struct SSets *input_set1, int membership1, double value1,
-        						struct SSets *output_set, int membership3, int method, double **fuzzy_values);
+void  FuzzyIfInput1 (	const struct SSets *input_set1, int membership1, double value1,
+        						const struct SSets *output_set, int membership3, int method, fuzzy_t **fuzzy_values);
 
-//-------------------------------------------------------------------------------------------------//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
 // Rule base for 2 inputs
 // input_set1	= input set 1
 // membership1	= membership function of input set 1
@@ -133,9 +142,35 @@ void  FuzzyIfInput1 (	struct SSets *input_set1, int membership1, double value1,
 // membership3	= membermship function of input set 3
 // method		= implication method  (MANDANI, LARSEN, ZADEH)
 // fuzzy_values	= array with implicated values
-void  FuzzyIfInput2 (	struct SSets *input_set1, int membership1, double value1, int op,
-        						struct SSets *input_set2, int membership2, double value2,
-	           					struct SSets *output_set, int membership3, int method, double **fuzzy_values);
+void  FuzzyIfInput2 (	const struct SSets *input_set1, int membership1, double value1, int op,
+        						const struct SSets *input_set2, int membership2, double value2,
+	           					const struct SSets *output_set, int membership3, int method, fuzzy_t **fuzzy_values);
+
+//-------------------------------------------------------------------------------------------------
+// Rule base for 1 input, reading the input degree vector returned by MembershipVector ()
+// degrees1		= degree vector of input set 1
+// membership1	= membership function of input set 1
+// output_set	= output set
+// membership3	= membermship function of input set 3
+// method		= implication method  (MANDANI, LARSEN, ZADEH)
+// fuzzy_values	= array with implicated values
+void  FuzzyIfVector1 (	const fuzzy_t *degrees1, int membership1,
+        						const struct SSets *output_set, int membership3, int method, fuzzy_t **fuzzy_values);
+
+//-------------------------------------------------------------------------------------------------
+// Rule base for 2 inputs, reading the input degree vectors returned by MembershipVector ()
+// degrees1		= degree vector of input set 1
+// membership1	= membership function of input set 1
+// op			= operator AND or OR
+// degrees2		= degree vector of input set 2
+// membership2	= membership function of input set 2
+// output_set	= output set
+// membership3	= membermship function of input set 3
+// method		= implication method  (MANDANI, LARSEN, ZADEH)
+// fuzzy_values	= array with implicated values
+void  FuzzyIfVector2 (	const fuzzy_t *degrees1, int membership1, int op,
+        						const fuzzy_t *degrees2, int membership2,
+	           					const struct SSets *output_set, int membership3, int method, fuzzy_t **fuzzy_values);
 
 
 
@@ -0,0 +1,171 @@
+/**
+ * @file
+ * @author  Andre Silva <andreluizeng@yahoo.com.br>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2012, Andre Luiz Vieira da Silva
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this software
+ *    must display the following acknowledgement:
+ *    This product includes software developed by the <organization>.
+ * 4. Neither the name of the <organization> nor the
+ *    names of its contributors may be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Andre Silva ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Andre Silva BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @section DESCRIPTION
+ *
+ */
+
+#ifndef __inference_h__
+#define __inference_h__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#include "openfuzz.h"
+
+#pragma once
+
+/**
+ * 	Inference context struct (aggregation vector reused by every inference)
+ * 	@param fuzzy_values vector with the aggregated (combined) rules
+ * 	@param npoints number of points of the vector
+ * 	@param allocations number of heap allocations made by the context since it was created
+ * 	@param first first point written since the last ClearInference ()
+ * 	@param last last point written since the last ClearInference () (first > last if nothing was written)
+ */
+struct SInference
+{
+      fuzzy_t *fuzzy_values;
+      long npoints;
+      long allocations;	// stays constant once the vectors are big enough for every set used
+      long first;
+      long last;
+};
+
+/**
+ * 	Allocates an inference context
+ * 	@param inference inference context pointer
+ * 	@param npoints  biggest number of discretization points of the output sets
+ *  @return TRUE if success or FALSE if it fails
+ *  @note	The rule functions below use only the context vectors, so once the context is allocated
+ *	an inference does not touch the heap (inference->allocations does not change). Usage:
+ *	@code
+ *	struct SInference *inference;
+ *	double output_value;
+ *
+ *	if (! InitializeInference (&inference, DISCRETE_PTS))
+ *		return 0;
+ *
+ *	while (running)
+ *	{
+ *		ClearInference (inference);
+ *
+ *		InferenceIfInput1 (inference, temperature, TEMP_COLD, temp_value, dutycycle_control, CONTROL_MIN, MANDANI);
+ *		InferenceIfInput1 (inference, temperature, TEMP_WARM, temp_value, dutycycle_control, CONTROL_MED, MANDANI);
+ *
+ *		output_value = InferenceDeFuzzy (inference, dutycycle_control, COA);
+ *	}
+ *
+ *	FreeInference (inference);
+ *	@endcode
+ */
+int InitializeInference (struct SInference **inference, long npoints);
+
+/**
+ * 	Releases an inference context allocated with InitializeInference ()
+ * 	@param inference inference context
+ *  @return nothing
+ */
+void FreeInference (struct SInference *inference);
+
+/**
+ * 	Clears the aggregated rules (to be called before the rules of each inference)
+ * 	@param inference inference context
+ *  @return nothing
+ *  @note Only the window [inference->first, inference->last] written by the rules is cleared.
+ */
+void ClearInference (struct SInference *inference);
+
+/**
+ * 	Aggregates one fired output membership in the inference context
+ * 	@param inference inference context
+ * 	@param output output membership (&output_set[membership])
+ * 	@param alpha rule firing strength
+ * 	@param method implication method  (MANDANI, LARSEN, ZADEH)
+ *  @return nothing
+ *  @note MANDANI and LARSEN only touch the support of the membership (output->first .. output->last), which
+ *	extends the window of the context; ZADEH writes every point.
+ */
+void InferenceImplication (struct SInference *inference, const struct SSets *output, double alpha, int method);
+
+/**
+ * 	Rule base for 1 input, aggregated in the inference context (same as FuzzyIfInput1 ())
+ * 	@param inference inference context
+ * 	@param input_set1 input set 1
+ * 	@param membership1 membership function of input set 1
+ * 	@param value1 crisp value of input 1
+ * 	@param output_set output set
+ * 	@param membership3 membership function of output set
+ * 	@param method implication method  (MANDANI, LARSEN, ZADEH)
+ *  @return nothing
+ */
+void InferenceIfInput1 (struct SInference *inference, const struct SSets *input_set1, int membership1, double value1,
+                        const struct SSets *output_set, int membership3, int method);
+
+/**
+ * 	Rule base for 2 inputs, aggregated in the inference context (same as FuzzyIfInput2 ())
+ * 	@param inference inference context
+ * 	@param input_set1 input set 1
+ * 	@param membership1 membership function of input set 1
+ * 	@param value1 crisp value of input 1
+ * 	@param op operator AND or OR
+ * 	@param input_set2 input set 2
+ * 	@param membership2 membership function of input set 2
+ * 	@param value2 crisp value of input 2
+ * 	@param output_set output set
+ * 	@param membership3 membership function of output set
+ * 	@param method implication method  (MANDANI, LARSEN, ZADEH)
+ *  @return nothing
+ */
+void InferenceIfInput2 (struct SInference *inference, const struct SSets *input_set1, int membership1, double value1, int op,
+                        const struct SSets *input_set2, int membership2, double value2,
+                        const struct SSets *output_set, int membership3, int method);
+
+/**
+ * 	Defuzzifies the rules aggregated in the inference context
+ * 	@param inference inference context
+ * 	@param output_set output set
+ * 	@param method  COA, MOM, FOM, LOM or BOA
+ *  @return crisp value (control value)
+ *  @note Only the window written by the rules is read (see DeFuzzyRange ()).
+ */
+double InferenceDeFuzzy (const struct SInference *inference, const struct SSets *output_set, int method);
+
+#endif
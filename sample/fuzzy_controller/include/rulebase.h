@@ -0,0 +1,492 @@
+/**
+ * @file
+ * @author  Andre Silva <andreluizeng@yahoo.com.br>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2012, Andre Luiz Vieira da Silva
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this software
+ *    must display the following acknowledgement:
+ *    This product includes software developed by the <organization>.
+ * 4. Neither the name of the <organization> nor the
+ *    names of its contributors may be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Andre Silva ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Andre Silva BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @section DESCRIPTION
+ *
+ */
+
+#ifndef __rulebase_h__
+#define __rulebase_h__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#include "openfuzz.h"
+
+#pragma once
+
+#define BATCH_SAMPLES	64	// samples evaluated together by InferBatch ()
+
+/**
+ * 	Rule antecedent struct ("input is membership")
+ * 	@param input input variable index
+ * 	@param membership membership function of the input variable
+ */
+struct SAntecedent
+{
+      int input;
+      int membership;
+};
+
+/**
+ * 	Rule struct (as added with AddRule ())
+ * 	@param op operator AND or OR applied to all the antecedents
+ * 	@param weight rule weight (multiplies the firing strength)
+ * 	@param output output variable index
+ * 	@param membership membership function of the output variable
+ * 	@param first index of the first antecedent in the rule base antecedent list
+ * 	@param nantecedents number of antecedents
+ */
+struct SRule
+{
+      int op;
+      double weight;
+      int output;
+      int membership;
+      int first;
+      int nantecedents;
+};
+
+/**
+ * 	Compiled rule struct (one entry of the instruction array built by CompileRuleBase ())
+ * 	@param first index of the first operand (operands are degree cache indexes)
+ * 	@param count number of operands
+ * 	@param output output variable index
+ * 	@param membership membership function of the output variable
+ * 	@param weight rule weight
+ * 	@param consequent index of (output, membership) in the consequent strengths
+ * 	@param pivot antecedent (degree cache index) with the narrowest support, the rule is listed under it in the
+ *	support index
+ */
+struct SRuleCode
+{
+      int first;
+      int count;
+      int output;
+      int membership;
+      double weight;
+      int consequent;
+      int pivot;
+};
+
+/**
+ * 	Support interval index of one input variable
+ * 	@param nbreaks number of breakpoints (support bounds of the sets, sorted)
+ * 	@param breaks breakpoints, segment k is [breaks[k - 1], breaks[k]) (open on the edges)
+ * 	@param first the sets with non zero degree in segment k are terms[first[k]] .. terms[first[k + 1] - 1]
+ * 	@param terms membership functions of each segment
+ * 	@param revision sum of the revisions of the sets when the index was built
+ */
+struct SSupportIndex
+{
+      int nbreaks;
+      double *breaks;
+      int *first;
+      int *terms;
+      unsigned int revision;
+};
+
+/**
+ * 	Per inference state of a rule base (everything Evaluate () writes), one per thread
+ * 	@param rules rule base the state was created for
+ * 	@param generation compilation of the rule base the state was created for
+ * 	@param noutputs number of output variables
+ * 	@param degrees degree cache, the membership degree of every (input variable, membership) of one inference
+ * 	@param inference inference context of each output variable (aggregate of the MOM, FOM, LOM and BOA outputs)
+ * 	@param strength_max biggest firing strength of the rules of each (output, membership)
+ * 	@param strength_min smallest firing strength of the rules of each (output, membership) (ZADEH)
+ * 	@param strength_sum sum of the firing strengths of the rules of each (output, term) (TSK)
+ * 	@param envelope envelope workspace of the COA_ANALYTIC and BOA_ANALYTIC outputs
+ * 	@param pair_memberships membership of each (membership, strength) pair given to DeFuzzyEnvelope ()
+ * 	@param pair_alphas strength of each (membership, strength) pair given to DeFuzzyEnvelope ()
+ * 	@param stamp last inference each OR rule was evaluated on (an OR rule is listed once per antecedent)
+ * 	@param tick inference counter
+ * 	@param active degree cache indexes with non zero support in the current inference
+ * 	@param nactive number of active degrees
+ * 	@param batch_degrees degrees of BATCH_SAMPLES samples, batch_degrees[slot * BATCH_SAMPLES + sample] (InferBatch ())
+ * 	@param batch_alpha firing strength of one rule for BATCH_SAMPLES samples
+ * 	@param batch_max strength_max of BATCH_SAMPLES samples, batch_max[consequent * BATCH_SAMPLES + sample]
+ * 	@param batch_min strength_min of BATCH_SAMPLES samples (ZADEH)
+ * 	@param batch_sum strength_sum of BATCH_SAMPLES samples (TSK)
+ * 	@param batch_inputs crisp inputs of one sample (TSK consequents)
+ */
+struct SRuleState
+{
+      const struct SRuleBase *rules;
+      unsigned int generation;
+      int noutputs;
+
+      double *degrees;
+      struct SInference **inference;
+
+      double *strength_max;
+      double *strength_min;
+      double *strength_sum;
+
+      struct SEnvelope *envelope;
+      int *pair_memberships;
+      double *pair_alphas;
+
+      unsigned int *stamp;
+      unsigned int tick;
+      int *active;
+      int nactive;
+
+      double *batch_degrees;
+      double *batch_alpha;
+      double *batch_max;
+      double *batch_min;
+      double *batch_sum;
+      double *batch_inputs;
+};
+
+/**
+ * 	Rule base struct
+ * 	@param ninputs number of input variables
+ * 	@param noutputs number of output variables
+ * 	@param method implication method (MANDANI, LARSEN, ZADEH, TSK)
+ * 	@param inputs fuzzy sets of each input variable
+ * 	@param outputs fuzzy sets of each output variable
+ * 	@param defuzzy defuzzification method of each output variable
+ * 	@param nterms number of consequent terms of each output variable (TSK)
+ * 	@param order order of the consequents of each output variable (TSK: 0 constant, 1 linear in the inputs)
+ * 	@param coefficients consequent coefficients of each output variable (TSK), one row of ninputs + 1 per term
+ * 	@param rules rules added with AddRule ()
+ * 	@param antecedents antecedents of all the rules
+ * 	@param code compiled rules, AND rules first and OR rules after them
+ * 	@param nand number of compiled AND rules
+ * 	@param operands degree cache index read by each compiled operand
+ * 	@param ndegrees number of degrees in the cache
+ * 	@param degree_offset index of the first degree of each input variable in the cache
+ * 	@param nconsequents number of (output, membership) pairs
+ * 	@param consequent_offset index of the first consequent of each output variable
+ * 	@param pruning TRUE if only the rules that can fire are evaluated (MANDANI, LARSEN and TSK)
+ * 	@param support support interval index of each input variable
+ * 	@param and_first AND rules listed under degree k are and_list[and_first[k]] .. and_list[and_first[k + 1] - 1]
+ * 	@param and_list compiled AND rules, grouped by pivot
+ * 	@param or_first OR rules with an antecedent on degree k are or_list[or_first[k]] .. or_list[or_first[k + 1] - 1]
+ * 	@param or_list compiled OR rules, grouped by antecedent
+ * 	@param generation number of compilations, a state is only valid for the compilation it was created for
+ * 	@param state state used by Evaluate () and InferBatch ()
+ */
+struct SRuleBase
+{
+      int ninputs;
+      int noutputs;
+      int method;
+
+      const struct SSets **inputs;
+      const struct SSets **outputs;
+      int *defuzzy;
+
+      int *nterms;
+      int *order;
+      double **coefficients;
+
+      struct SRule *rules;
+      int nrules;
+      int rules_capacity;
+
+      struct SAntecedent *antecedents;
+      int nantecedents;
+      int antecedents_capacity;
+
+      int compiled;
+      struct SRuleCode *code;
+      int nand;
+      int *operands;
+
+      int ndegrees;
+      int *degree_offset;
+
+      int nconsequents;
+      int *consequent_offset;
+
+      int pruning;
+      struct SSupportIndex *support;
+      int *and_first;
+      int *and_list;
+      int *or_first;
+      int *or_list;
+
+      unsigned int generation;
+      struct SRuleState *state;
+};
+
+/**
+ * 	Allocates a rule base
+ * 	@param rules rule base object pointer
+ * 	@param ninputs number of input variables
+ * 	@param noutputs number of output variables
+ * 	@param method implication method (MANDANI, LARSEN, ZADEH, TSK)
+ *  @return TRUE if success or FALSE if it fails
+ *  @note	With TSK the output variables are set with SetSugenoOutput () instead of SetRuleOutput ().
+ *	@n Usage:
+ *	@code
+ *	#define INPUT_TEMP		0
+ *	#define INPUT_HUMIDITY	1
+ *	#define OUTPUT_DUTY		0
+ *
+ *	struct SRuleBase *rules;
+ *	double inputs[2];
+ *	double outputs[1];
+ *
+ *	InitializeRuleBase (&rules, 2, 1, MANDANI);
+ *
+ *	SetRuleInput (rules, INPUT_TEMP, temperature);
+ *	SetRuleInput (rules, INPUT_HUMIDITY, humidity);
+ *	SetRuleOutput (rules, OUTPUT_DUTY, dutycycle_control, COA);
+ *
+ *	// if temperature is hot and humidity is low then duty cycle is max
+ *	AddRule (rules, AND, 1.0, OUTPUT_DUTY, CONTROL_MAX, 2, INPUT_TEMP, TEMP_HOT, INPUT_HUMIDITY, HUMIDITY_LOW);
+ *	// if temperature is cold then duty cycle is min
+ *	AddRule (rules, AND, 1.0, OUTPUT_DUTY, CONTROL_MIN, 1, INPUT_TEMP, TEMP_COLD);
+ *
+ *	if (! CompileRuleBase (rules))
+ *		return 0;
+ *
+ *	while (running)
+ *	{
+ *		inputs[INPUT_TEMP] = ReadTemperature ();
+ *		inputs[INPUT_HUMIDITY] = ReadHumidity ();
+ *
+ *		Evaluate (rules, inputs, outputs);
+ *	}
+ *
+ *	FreeRuleBase (rules);
+ *	@endcode
+ */
+int InitializeRuleBase (struct SRuleBase **rules, int ninputs, int noutputs, int method);
+
+/**
+ * 	Releases a rule base allocated with InitializeRuleBase () (the fuzzy sets are not released)
+ * 	@param rules rule base object
+ *  @return nothing
+ */
+void FreeRuleBase (struct SRuleBase *rules);
+
+/**
+ * 	Sets the fuzzy sets of an input variable
+ * 	@param rules rule base object
+ * 	@param input input variable index
+ * 	@param sets fuzzy sets of the variable (any membership mode)
+ *  @return TRUE if success or FALSE if it fails
+ */
+int SetRuleInput (struct SRuleBase *rules, int input, const struct SSets *sets);
+
+/**
+ * 	Sets the fuzzy sets of an output variable
+ * 	@param rules rule base object
+ * 	@param output output variable index
+ * 	@param sets fuzzy sets of the variable (allocated with InitializeSets (), or with any function for COA_ANALYTIC
+ *	and BOA_ANALYTIC)
+ * 	@param defuzzy defuzzification method (COA, MOM, FOM, LOM, BOA, COA_ANALYTIC, BOA_ANALYTIC)
+ *  @return TRUE if success or FALSE if it fails
+ */
+int SetRuleOutput (struct SRuleBase *rules, int output, const struct SSets *sets, int defuzzy);
+
+/**
+ * 	Sets the consequents of an output variable of a TSK rule base
+ * 	@param rules rule base object (TSK)
+ * 	@param output output variable index
+ * 	@param nterms number of consequent terms (the membership of AddRule () selects one of them)
+ * 	@param order 0 for constant consequents or 1 for consequents linear in the inputs
+ * 	@param coefficients order 0: one constant per term (nterms values)
+ *	@n order 1: one row of ninputs + 1 values per term, the constant first and then the coefficient of each
+ *	input variable (term k is coefficients[k * (ninputs + 1)] + sum coefficients[k * (ninputs + 1) + 1 + i] * inputs[i])
+ *  @return TRUE if success or FALSE if it fails
+ *  @note The coefficients are copied. The crisp output is the average of the terms weighted by the firing
+ *	strengths of their rules (sum w * z / sum w), or 0 if no rule fires: there is no output universe, so one
+ *	inference costs O(rules) instead of O(rules * npoints).
+ *	@code
+ *	// duty = 10 when cold, 40 + 0.5 * temperature when warm
+ *	double duty[2 * 2] = { 10.0, 0.0,
+ *						   40.0, 0.5 };
+ *
+ *	InitializeRuleBase (&rules, 1, 1, TSK);
+ *	SetRuleInput (rules, INPUT_TEMP, temperature);
+ *	SetSugenoOutput (rules, OUTPUT_DUTY, 2, 1, duty);
+ *
+ *	AddRule (rules, AND, 1.0, OUTPUT_DUTY, 0, 1, INPUT_TEMP, TEMP_COLD);
+ *	AddRule (rules, AND, 1.0, OUTPUT_DUTY, 1, 1, INPUT_TEMP, TEMP_WARM);
+ *	@endcode
+ */
+int SetSugenoOutput (struct SRuleBase *rules, int output, int nterms, int order, const double *coefficients);
+
+/**
+ * 	Adds a rule "if input_a is membership_a op input_b is membership_b op ... then output is membership"
+ * 	@param rules rule base object
+ * 	@param op operator AND or OR (applied to all the antecedents)
+ * 	@param weight rule weight, the firing strength is multiplied by it (normally 1.0)
+ * 	@param output output variable index
+ * 	@param membership membership function of the output variable (consequent term with TSK)
+ * 	@param nantecedents number of antecedents
+ *  @n
+ *	@n followed by nantecedents pairs of (int)
+ *	@param input input variable index
+ *	@param membership membership function of the input variable
+ *  @return TRUE if success or FALSE if it fails
+ */
+int AddRule (struct SRuleBase *rules, int op, double weight, int output, int membership, int nantecedents, ...);
+
+/**
+ * 	Adds a rule with the antecedents given in arrays (same as AddRule (), for rules built at run time)
+ * 	@param rules rule base object
+ * 	@param op operator AND or OR (applied to all the antecedents)
+ * 	@param weight rule weight, the firing strength is multiplied by it (normally 1.0)
+ * 	@param output output variable index
+ * 	@param membership membership function of the output variable (consequent term with TSK)
+ * 	@param nantecedents number of antecedents
+ * 	@param inputs input variable index of each antecedent
+ * 	@param memberships membership function of each antecedent
+ *  @return TRUE if success or FALSE if it fails
+ */
+int AddRuleArray (struct SRuleBase *rules, int op, double weight, int output, int membership, int nantecedents,
+                    const int *inputs, const int *memberships);
+
+/**
+ * 	Compiles the rules in a flat instruction array (to be called after the last AddRule () and before Evaluate ())
+ * 	@param rules rule base object
+ *  @return TRUE if success or FALSE if it fails
+ *  @note Operators and antecedents are resolved once here: each antecedent becomes an index in the degree
+ *	cache, so Evaluate () only runs minimum/maximum loops over cached degrees.
+ *	@n The support index of each input is built from the sets as they are now. A set given to Fuzzification ()
+ *	again changes its revision: Evaluate () then rebuilds the index of that input, EvaluateState () (which does
+ *	not modify the rule base) evaluates every rule until Evaluate () or CompileRuleBase () rebuilds it. Membership
+ *	vectors changed without Fuzzification () need a new CompileRuleBase ().
+ */
+int CompileRuleBase (struct SRuleBase *rules);
+
+/**
+ * 	Runs one inference: all the rules are fired, aggregated and the output variables defuzzified
+ * 	@param rules rule base object (compiled)
+ * 	@param inputs crisp value of each input variable
+ * 	@param outputs crisp value of each output variable
+ *  @return TRUE if success or FALSE if the rule base is not compiled (or a stale support index cannot be rebuilt)
+ *  @note Each membership degree is computed once per call (into state->degrees of the SRuleState the rule base
+ *	owns, rules->state), no matter how many rules read it. The degrees of MEMBERSHIP_INTERLEAVED inputs are copied from one MembershipVector () row.
+ *	@n With MANDANI and LARSEN a rule with zero firing strength adds nothing to the aggregation, so the support
+ *	index of each input gives the sets that can have a non zero degree and only the rules listed under them are
+ *	evaluated: the cost follows the number of active rules, not the size of the rule base. ZADEH rules add
+ *	1 - alpha even when they do not fire, so with ZADEH every rule is evaluated.
+ *	@n The rules are not clipped one by one: the firing strengths of the rules with the same consequent are
+ *	reduced to one strength first (max (min (a1, B), min (a2, B)) = min (max (a1, a2), B), the same for LARSEN),
+ *	so each output membership is clipped once per call. ZADEH needs the smallest strength too
+ *	(max (1 - a, min (a, B)) over the rules is max (1 - min a, min (max a, B))), it clips each membership twice.
+ *	@n COA_ANALYTIC and BOA_ANALYTIC outputs are not clipped at all: the consequent strengths are given to
+ *	DeFuzzyEnvelope (). COA outputs are clipped, aggregated and reduced in one pass by DeFuzzyAggregate (),
+ *	their aggregate is never stored; only MOM, FOM, LOM and BOA outputs use the inference context vector.
+ *	@n TSK rule bases only sum the strengths of the rules of each consequent term and evaluate each fired term once.
+ */
+int Evaluate (struct SRuleBase *rules, const double *inputs, double *outputs);
+
+/**
+ * 	Runs one inference per sample over column arrays (same results as one Evaluate () per sample)
+ * 	@param rules rule base object (compiled)
+ * 	@param inputs column of each input variable, inputs[input][sample]
+ * 	@param outputs column of each output variable, outputs[output][sample]
+ * 	@param nsamples number of samples
+ *  @return TRUE if success or FALSE if the rule base is not compiled
+ *  @note The samples are evaluated in chunks of BATCH_SAMPLES: the degrees of each (input, membership) are
+ *	computed for the whole chunk by DegreeKernel (), then each compiled rule is decoded once per chunk and its
+ *	operator runs across the samples (OperatorKernel ()), as does the reduction into the consequent strengths.
+ *	Only the clipping and defuzzification are done sample by sample. Every rule is evaluated (no support
+ *	pruning), MEMBERSHIP_ANALYTIC degrees can differ from Evaluate () by 1 or 2 ulp (see DegreeKernel ()).
+ *	@code
+ *	double *columns[2] = { temperatures, humidities };
+ *	double *results[1] = { duty_cycles };
+ *
+ *	InferBatch (rules, columns, results, nsamples);
+ *	@endcode
+ */
+int InferBatch (struct SRuleBase *rules, double * const *inputs, double * const *outputs, long nsamples);
+
+/**
+ * 	Allocates a per inference state for a compiled rule base
+ * 	@param state state object pointer
+ * 	@param rules rule base object (compiled)
+ *  @return TRUE if success or FALSE if it fails
+ *  @note EvaluateState () and InferBatchState () only read the rule base and its fuzzy sets and write the
+ *	state, so threads sharing one rule base can run inferences at the same time with one state each. A state
+ *	is only valid until the rule base is compiled again.
+ *	@code
+ *	// each worker thread
+ *	struct SRuleState *state;
+ *
+ *	if (! InitializeRuleState (&state, rules))
+ *		return 0;
+ *
+ *	while (running)
+ *		EvaluateState (rules, state, inputs, outputs);
+ *
+ *	FreeRuleState (state);
+ *	@endcode
+ */
+int InitializeRuleState (struct SRuleState **state, const struct SRuleBase *rules);
+
+/**
+ * 	Releases a state allocated with InitializeRuleState ()
+ * 	@param state state object
+ *  @return nothing
+ */
+void FreeRuleState (struct SRuleState *state);
+
+/**
+ * 	Same as Evaluate (), with the scratch data of the inference in a caller owned state
+ * 	@param rules rule base object (compiled, not modified)
+ * 	@param state state created with InitializeRuleState () for the rule base
+ * 	@param inputs crisp value of each input variable
+ * 	@param outputs crisp value of each output variable
+ *  @return TRUE if success or FALSE if the rule base is not compiled or the state does not belong to it
+ */
+int EvaluateState (const struct SRuleBase *rules, struct SRuleState *state, const double *inputs, double *outputs);
+
+/**
+ * 	Same as InferBatch (), with the scratch data of the inferences in a caller owned state
+ * 	@param rules rule base object (compiled, not modified)
+ * 	@param state state created with InitializeRuleState () for the rule base
+ * 	@param inputs column of each input variable, inputs[input][sample]
+ * 	@param outputs column of each output variable, outputs[output][sample]
+ * 	@param nsamples number of samples
+ *  @return TRUE if success or FALSE if the rule base is not compiled or the state does not belong to it
+ */
+int InferBatchState (const struct SRuleBase *rules, struct SRuleState *state, double * const *inputs, double * const *outputs, long nsamples);
+
+#endif
@@ -0,0 +1,147 @@
+/**
+ * @file
+ * @author  Andre Silva <andreluizeng@yahoo.com.br>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2012, Andre Luiz Vieira da Silva
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this software
+ *    must display the following acknowledgement:
+ *    This product includes software developed by the <organization>.
+ * 4. Neither the name of the <organization> nor the
+ *    names of its contributors may be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Andre Silva ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Andre Silva BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @section DESCRIPTION
+ *
+ */
+
+#ifndef __surface_h__
+#define __surface_h__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#include "openfuzz.h"
+
+#pragma once
+
+struct SRuleBase;
+
+#define SURFACE_MAX_INPUTS	8	// 2^ninputs table entries are read per interpolation
+#define SURFACE_ERROR_SAMPLES	64	// rule base evaluations per cell measuring the interpolation error (at least 2^ninputs)
+#define SURFACE_COARSE		2	// CompileSurface (): max_nodes stopped the refinement before target_error was met
+
+/**
+ * 	Control surface struct (crisp outputs of a rule base sampled on a regular grid of its inputs)
+ * 	@param ninputs number of input variables
+ * 	@param noutputs number of output variables
+ * 	@param resolution number of grid points of each input variable
+ * 	@param start first grid point of each input variable (start of its universe of discourse)
+ * 	@param scale (resolution - 1) / universe range of each input variable
+ * 	@param stride distance between two grid points of each input variable in the table (in nodes)
+ * 	@param nnodes number of grid points (nodes)
+ * 	@param table crisp outputs, table[node * noutputs + output]
+ * 	@param max_error biggest interpolation error measured against the rule base on a finer grid (an estimate, a
+ *	point between the measured ones can be a bit farther)
+ */
+struct SSurface
+{
+      int ninputs;
+      int noutputs;
+      int *resolution;
+      double *start;
+      double *scale;
+      long *stride;
+      long nnodes;
+      double *table;
+      double max_error;
+};
+
+/**
+ * 	Compiles a rule base into a control surface
+ * 	@param surface control surface object pointer
+ * 	@param rules rule base object (compiled)
+ * 	@param resolution initial number of grid points of each input variable (at least 2)
+ * 	@param target_error biggest interpolation error accepted (0 to keep the initial resolution)
+ * 	@param max_nodes biggest number of grid points the table may have
+ *  @return TRUE if success, SURFACE_COARSE if the surface is built but max_nodes stopped the refinement with
+ *	max_error still bigger than target_error, or FALSE if it fails (no surface)
+ *  @note The rule base is evaluated on every grid point and, to measure the interpolation error, on a finer grid:
+ *	each cell split in the same number of parts along every input, as many as SURFACE_ERROR_SAMPLES evaluations
+ *	per cell allow (64 parts for 1 input, 8 for 2, 4 for 3, and 2 from 4 inputs on: the middle of every edge,
+ *	the centre of every face and of every cell). While the error is bigger than target_error the cells are split
+ *	in two along every input (resolution becomes 2 * resolution - 1) as long as the table stays within max_nodes;
+ *	the error reached is left in surface->max_error. Inputs out of the universes are clamped to them by
+ *	EvaluateSurface ().
+ *	@code
+ *	struct SSurface *surface;
+ *	int resolution[2] = { 17, 17 };
+ *	int status;
+ *
+ *	status = CompileSurface (&surface, rules, resolution, 0.05, 1000000);
+ *	if (! status)
+ *		return 0;
+ *
+ *	if (status == SURFACE_COARSE)
+ *		printf ("target error not reached within the node budget\n");
+ *
+ *	printf ("max interpolation error: %f\n", surface->max_error);
+ *
+ *	while (running)
+ *	{
+ *		inputs[INPUT_TEMP] = ReadTemperature ();
+ *		inputs[INPUT_HUMIDITY] = ReadHumidity ();
+ *
+ *		EvaluateSurface (surface, inputs, outputs);
+ *	}
+ *
+ *	FreeSurface (surface);
+ *	@endcode
+ */
+int CompileSurface (struct SSurface **surface, struct SRuleBase *rules, const int *resolution, double target_error, long max_nodes);
+
+/**
+ * 	Releases a control surface allocated with CompileSurface ()
+ * 	@param surface control surface object
+ *  @return nothing
+ */
+void FreeSurface (struct SSurface *surface);
+
+/**
+ * 	Interpolates the crisp outputs of the control surface (multilinear interpolation)
+ * 	@param surface control surface object
+ * 	@param inputs crisp value of each input variable
+ * 	@param outputs crisp value of each output variable
+ *  @return nothing
+ *  @note One call reads the 2^ninputs nodes of the cell around the inputs, no rule is evaluated.
+ */
+void EvaluateSurface (const struct SSurface *surface, const double *inputs, double *outputs);
+
+#endif
@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "openfuzz.h"
+#include "openfuzz.hpp"
+
+// Checks that the loop of the sample controller (fuzzy_controller.c) does not touch the heap once it is
+// warmed up: after WARMUP ticks, inference->allocations must stay the same for NTICKS more ticks, over
+// the whole temperature range (and out of it), for every implication and defuzzification method.
+// A context created smaller than the output set grows in the first tick only.
+// Run by "make check", returns 1 if an allocation is counted after the warm-up.
+
+// temperature
+#define TEMP_COLD	0
+#define TEMP_WARM	1
+#define TEMP_HOT	2
+
+// controller
+#define	CONTROL_MIN 0
+#define	CONTROL_MED 1
+#define	CONTROL_MAX 2
+
+#define DISCRETE_PTS 10000
+
+#define WARMUP		1
+#define NTICKS		5000
+
+typedef openfuzz::Variable<openfuzz::Triangle, openfuzz::Triangle, openfuzz::Triangle> Temperature;
+typedef openfuzz::Variable<openfuzz::Triangle, openfuzz::Triangle, openfuzz::Triangle> DutyCycle;
+
+// the tables of the sample controller
+static constexpr openfuzz::Tables<Temperature, DISCRETE_PTS> temperature_tables (Temperature (5.0, 45.0,
+										openfuzz::Triangle (5.0, 5.0, 28.0),
+										openfuzz::Triangle (25.0, 28.5, 35.0),
+										openfuzz::Triangle (30.0, 45.0, 45.0)));
+
+static constexpr openfuzz::Tables<DutyCycle, DISCRETE_PTS> dutycycle_tables (DutyCycle (0.0, 100.0,
+										openfuzz::Triangle (0.0, 0.0, 20.0),
+										openfuzz::Triangle (20.0, 40.0, 70.0),
+										openfuzz::Triangle (50.0, 100.0, 100.0)));
+
+static const int methods[] = { MANDANI, LARSEN, ZADEH };
+static const char *method_names[] = { "MANDANI", "LARSEN", "ZADEH" };
+
+static const int defuzzifiers[] = { COA, MOM, FOM, LOM, BOA };
+static const char *defuzzifier_names[] = { "COA", "MOM", "FOM", "LOM", "BOA" };
+
+//-------------------------------------------------------------------------------------------------
+// one tick of the sample loop
+static double Tick (struct SInference *inference, double temp_value, int method, int defuzzy)
+{
+	const struct SSets *temperature = temperature_tables.sets;
+	const struct SSets *dutycycle_control = dutycycle_tables.sets;
+
+	ClearInference (inference);
+
+	InferenceIfInput1 (inference, temperature, TEMP_COLD, temp_value, dutycycle_control, CONTROL_MIN, method);
+	InferenceIfInput1 (inference, temperature, TEMP_WARM, temp_value, dutycycle_control, CONTROL_MED, method);
+	InferenceIfInput1 (inference, temperature, TEMP_HOT, temp_value, dutycycle_control, CONTROL_MAX, method);
+
+	return InferenceDeFuzzy (inference, dutycycle_control, defuzzy);
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// allocations counted by NTICKS ticks of a warmed up context
+static int Run (long npoints, int m, int d)
+{
+	int failed = 0;
+	long k;
+	long warm;
+	long before;
+	double temp_value;
+
+	struct SInference *inference;
+
+	if (! InitializeInference (&inference, npoints)) return 1;
+
+	before = inference->allocations;
+
+	for (k = 0; k < WARMUP; k++) Tick (inference, 25.0, methods[m], defuzzifiers[d]);
+
+	warm = inference->allocations;
+
+	// from 0 to 50 (the universe is 5 .. 45), then NaN
+	for (k = 0; k <= NTICKS; k++)
+	{
+		temp_value = (k < NTICKS) ? 50.0 * (double) k / (double) (NTICKS - 1) : NAN;
+		Tick (inference, temp_value, methods[m], defuzzifiers[d]);
+	}
+
+	if (inference->allocations != warm)
+	{
+		printf ("\nError: %s %s context of %ld points: %ld allocations after the warm-up, %ld after %d ticks\n",
+				method_names[m], defuzzifier_names[d], npoints, warm, inference->allocations, NTICKS + 1);
+		failed = 1;
+	}
+
+	// the warm-up grows a small context once, to the points of the output set
+	if ((npoints < DISCRETE_PTS) && (warm != before + 1))
+	{
+		printf ("\nError: %s %s context of %ld points: %ld allocations in the warm-up, 1 expected\n",
+				method_names[m], defuzzifier_names[d], npoints, warm - before);
+		failed = 1;
+	}
+
+	if ((npoints >= DISCRETE_PTS) && (warm != before))
+	{
+		printf ("\nError: %s %s context of %ld points: %ld allocations in the warm-up, 0 expected\n",
+				method_names[m], defuzzifier_names[d], npoints, warm - before);
+		failed = 1;
+	}
+
+	FreeInference (inference);
+
+	return failed;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int main (int argc, char **argv)
+{
+	int m;
+	int d;
+	int failed = 0;
+
+	for (m = 0; m < (int) (sizeof (methods) / sizeof (methods[0])); m++)
+	{
+		for (d = 0; d < (int) (sizeof (defuzzifiers) / sizeof (defuzzifiers[0])); d++)
+		{
+			// as the sample (InitializeInference () with the points of the output), and smaller
+			failed += Run (DISCRETE_PTS, m, d);
+			failed += Run (1, m, d);
+		}
+	}
+
+	if (failed)
+	{
+		printf ("\ncheck_allocations: %d contexts allocated after the warm-up\n", failed);
+		return 1;
+	}
+
+	printf ("check_allocations: ok\n");
+
+	return 0;
+}
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,356 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "openfuzz.h"
+
+// Checks that the compiled rule base gives the same crisp outputs on every path (Evaluate (),
+// EvaluateState (), InferBatch () and ExecuteBatch ()) as the rules written one by one with
+// FuzzyIfInput1 () / FuzzyIfInput2 () and defuzzified with DeFuzzy (), for the MANDANI, LARSEN and
+// ZADEH implications (TSK rule bases have no FuzzyIf* counterpart), AND / OR rules, rule weights and
+// every defuzzification method.
+// Run by "make check", returns 1 if a difference is out of the tolerance.
+
+#define NINPUTS		3
+#define NOUTPUTS	2
+#define NSAMPLES	4099
+#define NTHREADS	4
+
+// same output, reduced in a different order (COA and BOA sums): relative to the output range
+#define TOLERANCE	1e-9
+
+// COA_ANALYTIC and BOA_ANALYTIC defuzzify the exact envelope and the reference is the discrete COA / BOA
+// of the same rules: COA within 2 discretization steps of the output, BOA within 1% of the output range
+// (the bisector moves a lot where the aggregate is almost zero, as between two sets that only touch) or,
+// out of it, where the area on the left of the result is half of the total within BOA_ANALYTIC_AREA.
+// The four paths must still agree with each other within TOLERANCE.
+#define COA_ANALYTIC_STEPS	2.0
+#define BOA_ANALYTIC_RANGE	0.01
+#define BOA_ANALYTIC_AREA	2e-3
+
+// one rule: op, weight, output variable and membership, one or two antecedents (input, membership)
+struct SCheckRule
+{
+	int op;
+	double weight;
+	int output;
+	int membership;
+	int nantecedents;
+	int input[2];
+	int term[2];
+};
+
+static const struct SCheckRule check_rules[] =
+{
+	{ AND, 1.0, 0, 0, 2, { 0, 1 }, { 0, 0 } },
+	{ OR,  1.0, 0, 1, 2, { 0, 1 }, { 1, 2 } },
+	{ AND, 0.7, 0, 2, 2, { 0, 2 }, { 2, 1 } },
+	{ OR,  0.5, 0, 1, 2, { 1, 2 }, { 1, 0 } },
+	{ AND, 1.0, 0, 2, 1, { 1, 0 }, { 2, 0 } },
+	{ AND, 0.8, 0, 0, 1, { 2, 0 }, { 0, 0 } },
+	{ OR,  1.0, 1, 0, 2, { 0, 2 }, { 0, 0 } },
+	{ AND, 0.6, 1, 1, 2, { 0, 1 }, { 2, 2 } },
+	{ OR,  0.9, 1, 1, 2, { 1, 2 }, { 0, 1 } },
+	{ AND, 1.0, 1, 0, 1, { 0, 0 }, { 1, 0 } },
+};
+
+#define NRULES ((int) (sizeof (check_rules) / sizeof (check_rules[0])))
+
+static const int methods[] = { MANDANI, LARSEN, ZADEH };
+static const char *method_names[] = { "MANDANI", "LARSEN", "ZADEH" };
+
+static const int defuzzifiers[] = { COA, MOM, FOM, LOM, BOA, COA_ANALYTIC, BOA_ANALYTIC };
+static const char *defuzzifier_names[] = { "COA", "MOM", "FOM", "LOM", "BOA", "COA_ANALYTIC", "BOA_ANALYTIC" };
+
+static const char *path_names[] = { "Evaluate ()", "EvaluateState ()", "InferBatch ()", "ExecuteBatch ()" };
+
+static struct SSets *inputs[NINPUTS];
+static struct SSets *outputs[NOUTPUTS];
+
+//-------------------------------------------------------------------------------------------------
+static int InitializeVariables (void)
+{
+	// one input per membership mode
+	if (! InitializeSets (&inputs[0], 3, 1000, 5.0, 45.0, 0.0)) return FALSE;
+	if (! InitializeInterleavedSets (&inputs[1], 3, 500, 0.0, 100.0, 0.0)) return FALSE;
+	if (! InitializeAnalyticSets (&inputs[2], 2, 0.0, 10.0)) return FALSE;
+
+	if (! InitializeSets (&outputs[0], 3, 1000, 0.0, 100.0, 0.0)) return FALSE;
+	if (! InitializeSets (&outputs[1], 2, 800, 0.0, 10.0, 0.0)) return FALSE;
+
+	Fuzzification (&inputs[0][0], TRIANGULAR, 5.0, 5.0, 28.0);
+	Fuzzification (&inputs[0][1], TRIANGULAR, 25.0, 28.5, 35.0);
+	Fuzzification (&inputs[0][2], TRAPEZOIDAL, 30.0, 40.0, 45.0, 45.0);
+
+	Fuzzification (&inputs[1][0], TRIANGULAR, 0.0, 0.0, 50.0);
+	Fuzzification (&inputs[1][1], GAUSSIAN, 50.0, 15.0);
+	Fuzzification (&inputs[1][2], TRIANGULAR, 50.0, 100.0, 100.0);
+
+	Fuzzification (&inputs[2][0], TRIANGULAR, 0.0, 0.0, 7.0);
+	Fuzzification (&inputs[2][1], TRIANGULAR, 3.0, 10.0, 10.0);
+
+	Fuzzification (&outputs[0][0], TRIANGULAR, 0.0, 0.0, 20.0);
+	Fuzzification (&outputs[0][1], TRIANGULAR, 20.0, 40.0, 70.0);
+	Fuzzification (&outputs[0][2], TRAPEZOIDAL, 50.0, 60.0, 100.0, 100.0);
+
+	Fuzzification (&outputs[1][0], TRIANGULAR, 0.0, 0.0, 6.0);
+	Fuzzification (&outputs[1][1], TRIANGULAR, 4.0, 10.0, 10.0);
+
+	return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static struct SRuleBase *BuildRuleBase (int method, int defuzzy)
+{
+	int i;
+	struct SRuleBase *rules;
+
+	if (! InitializeRuleBase (&rules, NINPUTS, NOUTPUTS, method)) return NULL;
+
+	for (i = 0; i < NINPUTS; i++) SetRuleInput (rules, i, inputs[i]);
+	for (i = 0; i < NOUTPUTS; i++) SetRuleOutput (rules, i, outputs[i], defuzzy);
+
+	for (i = 0; i < NRULES; i++)
+	{
+		const struct SCheckRule *rule = &check_rules[i];
+
+		AddRuleArray (rules, rule->op, rule->weight, rule->output, rule->membership, rule->nantecedents, rule->input, rule->term);
+	}
+
+	if (! CompileRuleBase (rules))
+	{
+		FreeRuleBase (rules);
+		return NULL;
+	}
+
+	return rules;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// the rules one by one: FuzzyIfInput1 () / FuzzyIfInput2 () for the rules of weight 1, the weighted
+// ones combined here and aggregated with ImplicationKernel () (the FuzzyIfVector* degrees are fuzzy_t,
+// single precision strengths would not match the rule base in the float build)
+static void Reference (const double *crisp, int method, int defuzzy, fuzzy_t **fuzzy_values, double *results)
+{
+	int i;
+	int k;
+	int reference;
+	double alpha;
+	double degree;
+
+	for (i = 0; i < NOUTPUTS; i++) memset (fuzzy_values[i], 0, sizeof (fuzzy_t) * outputs[i][0].npoints);
+
+	for (i = 0; i < NRULES; i++)
+	{
+		const struct SCheckRule *rule = &check_rules[i];
+		struct SSets *set1 = inputs[rule->input[0]];
+		struct SSets *set2 = inputs[rule->input[1]];
+		fuzzy_t **aggregation = &fuzzy_values[rule->output];
+
+		if (rule->weight == 1.0)
+		{
+			if (rule->nantecedents == 1)
+				FuzzyIfInput1 (set1, rule->term[0], crisp[rule->input[0]], outputs[rule->output], rule->membership, method, aggregation);
+			else
+				FuzzyIfInput2 (set1, rule->term[0], crisp[rule->input[0]], rule->op, set2, rule->term[1], crisp[rule->input[1]],
+							   outputs[rule->output], rule->membership, method, aggregation);
+			continue;
+		}
+
+		alpha = MembershipDegree (&set1[rule->term[0]], crisp[rule->input[0]]);
+
+		for (k = 1; k < rule->nantecedents; k++)
+		{
+			degree = MembershipDegree (&inputs[rule->input[k]][rule->term[k]], crisp[rule->input[k]]);
+			alpha = (rule->op == AND) ? Minimum (alpha, degree) : Maximum (alpha, degree);
+		}
+
+		ImplicationKernel (*aggregation, outputs[rule->output][rule->membership].value, outputs[rule->output][0].npoints,
+						   rule->weight * alpha, method);
+	}
+
+	// DeFuzzy () computes the analytic methods on the discrete vector (as COA and BOA)
+	reference = defuzzy;
+	if (defuzzy == COA_ANALYTIC) reference = COA;
+	if (defuzzy == BOA_ANALYTIC) reference = BOA;
+
+	for (i = 0; i < NOUTPUTS; i++) results[i] = DeFuzzy (fuzzy_values[i], outputs[i], reference);
+
+	return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// area of the discrete aggregate on the left of a crisp value, as a fraction of the total
+static double LeftArea (const fuzzy_t *aggregate, const struct SSets *output, double crisp)
+{
+	long i;
+	double left = 0;
+	double total = 0;
+
+	for (i = 0; i < output[0].npoints; i++)
+	{
+		total += aggregate[i];
+		if (UniverseDiscPos (output[0].universe, i) < crisp) left += aggregate[i];
+	}
+
+	return (total > 0) ? left / total : 0.5;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int main (int argc, char **argv)
+{
+	int m;
+	int d;
+	int i;
+	long k;
+	int failed = 0;
+
+	static double columns[NINPUTS][NSAMPLES];
+	static double batch[NOUTPUTS][NSAMPLES];
+	static double executed[NOUTPUTS][NSAMPLES];
+
+	double *input_columns[NINPUTS];
+	double *batch_columns[NOUTPUTS];
+	double *executed_columns[NOUTPUTS];
+
+	fuzzy_t *fuzzy_values[NOUTPUTS];
+
+	if (! InitializeVariables ()) return 1;
+
+	for (i = 0; i < NOUTPUTS; i++)
+	{
+		fuzzy_values[i] = (fuzzy_t *) malloc (sizeof (fuzzy_t) * outputs[i][0].npoints);
+		if (fuzzy_values[i] == NULL) return 1;
+
+		batch_columns[i] = batch[i];
+		executed_columns[i] = executed[i];
+	}
+
+	// random samples a bit out of the universes (clamped), and the peaks and edges of the sets
+	srand (7);
+	for (i = 0; i < NINPUTS; i++)
+	{
+		double start = inputs[i][0].start_uod;
+		double range = inputs[i][0].stop_uod - start;
+
+		input_columns[i] = columns[i];
+
+		for (k = 0; k < NSAMPLES; k++) columns[i][k] = start - 0.05 * range + 1.1 * range * rand () / RAND_MAX;
+	}
+
+	columns[0][0] = 5.0;	columns[0][1] = 28.0;	columns[0][2] = 28.5;	columns[0][3] = 45.0;
+	columns[1][0] = 0.0;	columns[1][1] = 50.0;	columns[1][2] = 100.0;	columns[1][3] = 50.0;
+	columns[2][0] = 0.0;	columns[2][1] = 7.0;	columns[2][2] = 3.0;	columns[2][3] = 10.0;
+
+	for (m = 0; m < (int) (sizeof (methods) / sizeof (methods[0])); m++)
+	{
+		for (d = 0; d < (int) (sizeof (defuzzifiers) / sizeof (defuzzifiers[0])); d++)
+		{
+			double worst[4] = { 0, 0, 0, 0 };
+			double bound[NOUTPUTS];
+			double agreement[NOUTPUTS];
+
+			struct SRuleBase *rules;
+			struct SRuleState *state;
+			struct SExecutor *executor;
+
+			rules = BuildRuleBase (methods[m], defuzzifiers[d]);
+			if (rules == NULL) return 1;
+
+			if (! InitializeRuleState (&state, rules)) return 1;
+			if (! InitializeExecutor (&executor, rules, NTHREADS, FALSE)) return 1;
+
+			if (! InferBatch (rules, input_columns, batch_columns, NSAMPLES)) return 1;
+			if (! ExecuteBatch (executor, input_columns, executed_columns, NSAMPLES)) return 1;
+
+			for (i = 0; i < NOUTPUTS; i++)
+			{
+				double range = outputs[i][0].stop_uod - outputs[i][0].start_uod;
+
+				agreement[i] = TOLERANCE * range;
+
+				switch (defuzzifiers[d])
+				{
+					case COA_ANALYTIC:	bound[i] = COA_ANALYTIC_STEPS * outputs[i][0].universe->step;
+										break;
+
+					case BOA_ANALYTIC:	bound[i] = BOA_ANALYTIC_RANGE * range;
+										break;
+
+					default:			bound[i] = agreement[i];
+										break;
+				}
+			}
+
+			for (k = 0; k < NSAMPLES; k++)
+			{
+				double crisp[NINPUTS];
+				double reference[NOUTPUTS];
+				double evaluated[NOUTPUTS];
+				double stated[NOUTPUTS];
+
+				for (i = 0; i < NINPUTS; i++) crisp[i] = columns[i][k];
+
+				Reference (crisp, methods[m], defuzzifiers[d], fuzzy_values, reference);
+
+				if (! Evaluate (rules, crisp, evaluated)) return 1;
+				if (! EvaluateState (rules, state, crisp, stated)) return 1;
+
+				for (i = 0; i < NOUTPUTS; i++)
+				{
+					double values[4];
+					double diff;
+					int p;
+
+					values[0] = evaluated[i];
+					values[1] = stated[i];
+					values[2] = batch[i][k];
+					values[3] = executed[i][k];
+
+					for (p = 0; p < 4; p++)
+					{
+						diff = fabs (values[p] - reference[i]);
+						if (diff > worst[p]) worst[p] = diff;
+
+						if ((defuzzifiers[d] == BOA_ANALYTIC) && (fabs (LeftArea (fuzzy_values[i], outputs[i], values[p]) - 0.5) <= BOA_ANALYTIC_AREA))
+							diff = 0;
+
+						// NaN fails too
+						if ((! (diff <= bound[i])) || (! (fabs (values[p] - values[0]) <= agreement[i])))
+						{
+							if (failed < 20)
+								printf ("\nError: %s %s output %d sample %ld: %s gives %.12g, Evaluate () %.12g, reference %.12g\n",
+										method_names[m], defuzzifier_names[d], i, k, path_names[p], values[p], values[0], reference[i]);
+							failed++;
+						}
+					}
+				}
+			}
+
+			printf ("%-8s %-13s worst |diff|: Evaluate %.3g  EvaluateState %.3g  InferBatch %.3g  ExecuteBatch %.3g\n",
+					method_names[m], defuzzifier_names[d], worst[0], worst[1], worst[2], worst[3]);
+
+			FreeExecutor (executor);
+			FreeRuleState (state);
+			FreeRuleBase (rules);
+		}
+	}
+
+	for (i = 0; i < NOUTPUTS; i++) free (fuzzy_values[i]);
+	for (i = 0; i < NINPUTS; i++) FreeSets (inputs[i]);
+	for (i = 0; i < NOUTPUTS; i++) FreeSets (outputs[i]);
+
+	if (failed)
+	{
+		printf ("\ncheck_equivalence: %d differences out of the tolerance\n", failed);
+		return 1;
+	}
+
+	printf ("\ncheck_equivalence: ok\n");
+	return 0;
+}
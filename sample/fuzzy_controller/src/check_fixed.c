@@ -0,0 +1,267 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "openfuzz.h"
+
+// Checks the fixed point engine (Q15 tables, fixed.h) against the floating point engine with the
+// sample controller (temperature cold / warm / hot -> duty cycle min / med / max), over the whole
+// temperature range on 1000 and 10000 points, with the same Q16.16 inputs and the bounds documented
+// by FixedDeFuzzy ():
+//   COA                within 1e-4 of the output range (MANDANI, ZADEH), 1e-3 (LARSEN)
+//   BOA                within one discretization point (MANDANI, ZADEH), 1e-3 of the output range (LARSEN)
+//   MOM, FOM and LOM   the same point, unless two maxima of the aggregate are within one Q15 step:
+//                      the result is then anywhere among those maxima
+//   every firing strength below 1 / 65536: the fixed point output is 0
+// The same tables given to LoadFixedSets () (the path of the cores with no FPU) must give the same sets
+// and the same Q16.16 outputs.
+// Run by "make check", returns 1 if a difference is out of the bound.
+
+#define NSAMPLES	4401
+
+#define COA_RANGE	1e-4
+#define LARSEN_RANGE	1e-3
+
+// the fixed point result is a Q16.16 position
+#define POSITION_SLACK	(2.0 / 65536.0)
+
+#define Q15_STEP	(1.0 / 32768.0)
+#define WEAK_STRENGTH	(1.0 / 65536.0)
+
+static const int points[] = { 1000, 10000 };
+
+static const int methods[] = { MANDANI, LARSEN, ZADEH };
+static const char *method_names[] = { "MANDANI", "LARSEN", "ZADEH" };
+
+static const int defuzzifiers[] = { COA, BOA, MOM, FOM, LOM };
+static const char *defuzzifier_names[] = { "COA", "BOA", "MOM", "FOM", "LOM" };
+
+//-------------------------------------------------------------------------------------------------
+// MOM, FOM and LOM: the window of the floating point aggregate within one Q15 step of its maximum,
+// returns FALSE if other points than the maxima are in it (a tie the fixed point engine can resolve
+// differently)
+static int MaximumWindow (const struct SInference *inference, const struct SSets *output, double *low, double *high)
+{
+	long i;
+	long last;
+	long first_near = -1;
+	long last_near = -1;
+	long nmax = 0;
+	long nnear = 0;
+	double max = 0;
+
+	last = inference->last;
+	if (last > output[0].npoints - 1) last = output[0].npoints - 1;
+
+	for (i = inference->first; i <= last; i++)
+		if (inference->fuzzy_values[i] > max) max = inference->fuzzy_values[i];
+
+	for (i = inference->first; i <= last; i++)
+	{
+		if (inference->fuzzy_values[i] == max) nmax++;
+
+		if (inference->fuzzy_values[i] >= max - Q15_STEP)
+		{
+			if (first_near < 0) first_near = i;
+			last_near = i;
+			nnear++;
+		}
+	}
+
+	*low = UniverseDiscPos (output[0].universe, first_near);
+	*high = UniverseDiscPos (output[0].universe, last_near);
+
+	return nnear == nmax;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int SameFixedSet (const struct SFixedSets *a, const struct SFixedSets *b)
+{
+	return (a->value == b->value) && (a->nsets == b->nsets) && (a->npoints == b->npoints) && (a->start_uod == b->start_uod) &&
+		   (a->stop_uod == b->stop_uod) && (a->scale.mult == b->scale.mult) && (a->scale.shift == b->scale.shift) &&
+		   (a->step.mult == b->step.mult) && (a->step.shift == b->step.shift) && (a->first == b->first) && (a->last == b->last);
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int Compare (int npoints)
+{
+	int m;
+	int d;
+	int r;
+	int failed = 0;
+	long k;
+
+	struct SSets *temperature;
+	struct SSets *control;
+	struct SFixedSets *fixed_temperature;
+	struct SFixedSets *fixed_control;
+	struct SFixedSets *loaded_temperature;
+	struct SFixedSets *loaded_control;
+	struct SInference *inference;
+	struct SFixedInference *fixed_inference;
+	struct SFixedInference *loaded_inference;
+
+	if (! InitializeSets (&temperature, 3, npoints, 5.0, 45.0, 0.0)) return 1;
+	if (! InitializeSets (&control, 3, npoints, 0.0, 100.0, 0.0)) return 1;
+
+	Fuzzification (&temperature[0], TRIANGULAR, 5.0, 5.0, 28.0);
+	Fuzzification (&temperature[1], TRIANGULAR, 25.0, 28.5, 35.0);
+	Fuzzification (&temperature[2], TRIANGULAR, 30.0, 45.0, 45.0);
+
+	Fuzzification (&control[0], TRIANGULAR, 0.0, 0.0, 20.0);
+	Fuzzification (&control[1], TRIANGULAR, 20.0, 40.0, 70.0);
+	Fuzzification (&control[2], TRIANGULAR, 50.0, 100.0, 100.0);
+
+	if ((! InitializeFixedSets (&fixed_temperature, temperature)) || (! InitializeFixedSets (&fixed_control, control))) return 1;
+	if ((! InitializeInference (&inference, npoints)) || (! InitializeFixedInference (&fixed_inference, npoints))) return 1;
+
+	// the tables written by InitializeFixedSets (), as a host would generate them
+	if ((! LoadFixedSets (&loaded_temperature, fixed_temperature[0].value, 3, npoints, fixed_temperature[0].start_uod, fixed_temperature[0].stop_uod)) ||
+		(! LoadFixedSets (&loaded_control, fixed_control[0].value, 3, npoints, fixed_control[0].start_uod, fixed_control[0].stop_uod)) ||
+		(! InitializeFixedInference (&loaded_inference, npoints))) return 1;
+
+	for (r = 0; r < 3; r++)
+	{
+		if ((! SameFixedSet (&loaded_temperature[r], &fixed_temperature[r])) || (! SameFixedSet (&loaded_control[r], &fixed_control[r])))
+		{
+			printf ("\nError: %d points set %d: LoadFixedSets () and InitializeFixedSets () give different sets\n", npoints, r);
+			failed++;
+		}
+	}
+
+	for (m = 0; m < (int) (sizeof (methods) / sizeof (methods[0])); m++)
+	{
+		for (d = 0; d < (int) (sizeof (defuzzifiers) / sizeof (defuzzifiers[0])); d++)
+		{
+			int ties = 0;
+			double worst = 0;
+			double range = control[0].stop_uod - control[0].start_uod;
+
+			for (k = 0; k < NSAMPLES; k++)
+			{
+				// a bit out of the universe on both sides (clamped), the same Q16.16 value for both engines
+				int32_t input = DOUBLE_TO_Q16 (3.0 + 44.0 * (double) k / (double) (NSAMPLES - 1));
+				double x = Q16_TO_DOUBLE (input);
+				double strength = 0;
+				double value;
+				double fixed;
+				int32_t fixed_q16;
+				int32_t loaded_q16;
+				double low;
+				double high;
+				double bound;
+				double diff;
+
+				ClearInference (inference);
+				ClearFixedInference (fixed_inference);
+				ClearFixedInference (loaded_inference);
+
+				// cold -> min, warm -> med, hot -> max
+				for (r = 0; r < 3; r++)
+				{
+					InferenceIfInput1 (inference, temperature, r, x, control, r, methods[m]);
+					FixedIfInput1 (fixed_inference, fixed_temperature, r, input, fixed_control, r, methods[m]);
+					FixedIfInput1 (loaded_inference, loaded_temperature, r, input, loaded_control, r, methods[m]);
+
+					if (MembershipDegree (&temperature[r], x) > strength) strength = MembershipDegree (&temperature[r], x);
+				}
+
+				value = InferenceDeFuzzy (inference, control, defuzzifiers[d]);
+				fixed_q16 = FixedDeFuzzy (fixed_inference, fixed_control, defuzzifiers[d]);
+				loaded_q16 = FixedDeFuzzy (loaded_inference, loaded_control, defuzzifiers[d]);
+				fixed = Q16_TO_DOUBLE (fixed_q16);
+
+				if (loaded_q16 != fixed_q16)
+				{
+					if (failed < 20)
+						printf ("\nError: %d points %s %s temperature %g: LoadFixedSets () %.9g, InitializeFixedSets () %.9g\n",
+								npoints, method_names[m], defuzzifier_names[d], x, Q16_TO_DOUBLE (loaded_q16), fixed);
+					failed++;
+				}
+
+				low = value;
+				high = value;
+
+				switch (defuzzifiers[d])
+				{
+					case COA:	bound = (methods[m] == LARSEN ? LARSEN_RANGE : COA_RANGE) * range;
+								break;
+
+					case BOA:	bound = (methods[m] == LARSEN ? LARSEN_RANGE * range : control[0].universe->step) + POSITION_SLACK;
+								break;
+
+					default:	if (! MaximumWindow (inference, control, &low, &high))
+								{
+									ties++;
+								}
+								else
+								{
+									low = value;
+									high = value;
+								}
+
+								bound = POSITION_SLACK;
+								break;
+				}
+
+				if (strength < WEAK_STRENGTH)
+				{
+					low = 0;
+					high = 0;
+					bound = 0;
+				}
+
+				diff = 0;
+				if (fixed < low) diff = low - fixed;
+				if (fixed > high) diff = fixed - high;
+
+				if (diff > worst) worst = diff;
+
+				// NaN fails too
+				if (! (diff <= bound))
+				{
+					if (failed < 20)
+						printf ("\nError: %d points %s %s temperature %g: fixed point %.9g, floating point %.9g\n",
+								npoints, method_names[m], defuzzifier_names[d], x, fixed, value);
+					failed++;
+				}
+			}
+
+			printf ("%5d points %-8s %-4s worst |diff| / range %.3g (%d ties)\n", npoints, method_names[m], defuzzifier_names[d],
+					worst / range, ties);
+		}
+	}
+
+	FreeFixedInference (loaded_inference);
+	FreeFixedInference (fixed_inference);
+	FreeFixedSets (loaded_temperature);
+	FreeFixedSets (loaded_control);
+	FreeInference (inference);
+	FreeFixedSets (fixed_temperature);
+	FreeFixedSets (fixed_control);
+	FreeSets (temperature);
+	FreeSets (control);
+
+	return failed;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int main (int argc, char **argv)
+{
+	int p;
+	int failed = 0;
+
+	for (p = 0; p < (int) (sizeof (points) / sizeof (points[0])); p++) failed += Compare (points[p]);
+
+	if (failed)
+	{
+		printf ("\ncheck_fixed: %d differences out of the bound\n", failed);
+		return 1;
+	}
+
+	printf ("\ncheck_fixed: ok\n");
+	return 0;
+}
@@ -0,0 +1,500 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "openfuzz.h"
+
+// Checks the precision of the membership tables and aggregates against a double precision
+// reference computed here from MembershipValue (), at every kernel level (scalar, SSE2, AVX2), with
+// a 3 input, 3 output rule base over 3001 samples. Meant to be built both ways: with double tables
+// and with FUZZY_FLAGS=-DOPENFUZZ_FLOAT (single precision tables), the bounds are the ones of the
+// float build:
+//   COA                within 1.4e-8 of the output range
+//   BOA                the same discretization point as the reference
+//   MOM, FOM and LOM   within one discretization step (rounding can change which points tie at the
+//                      maximum or reach a clipped plateau)
+// and every kernel level must give exactly the same outputs.
+// Run by "make check", returns 1 if a difference is out of the bound.
+
+#define NINPUTS		3
+#define NOUTPUTS	3
+#define NRULES		20
+#define NSAMPLES	3001
+
+#define COA_RANGE	1.4e-8
+#define MAXIMUM_STEPS	1.0
+
+// two points one step apart can be a few ulp more than the step away
+#define STEP_SLACK	1e-9
+
+// BOA ties: the area on the left of a point equal to half of the total area within this fraction of it
+#define BOA_TIE		1e-12
+
+// one rule: op, weight, output variable and membership, one to three antecedents (input, membership)
+struct SCheckRule
+{
+	int op;
+	double weight;
+	int output;
+	int membership;
+	int nantecedents;
+	int input[3];
+	int term[3];
+};
+
+static struct SCheckRule check_rules[NRULES];
+
+static const int methods[] = { MANDANI, LARSEN, ZADEH };
+static const char *method_names[] = { "MANDANI", "LARSEN", "ZADEH" };
+
+static const int defuzzifiers[] = { COA, MOM, FOM, LOM, BOA };
+static const char *defuzzifier_names[] = { "COA", "MOM", "FOM", "LOM", "BOA" };
+
+static const char *level_names[] = { "scalar", "SSE2", "AVX2" };
+
+static struct SSets *inputs[NINPUTS];
+static struct SSets *outputs[NOUTPUTS];
+
+//-------------------------------------------------------------------------------------------------
+static int InitializeVariables (void)
+{
+	// one input per membership mode
+	if (! InitializeSets (&inputs[0], 3, 1000, 5.0, 45.0, 0.0)) return FALSE;
+	if (! InitializeAnalyticSets (&inputs[1], 3, 0.0, 100.0)) return FALSE;
+	if (! InitializeInterleavedSets (&inputs[2], 2, 500, 0.0, 10.0, 0.0)) return FALSE;
+
+	if (! InitializeSets (&outputs[0], 3, 1000, 0.0, 100.0, 0.0)) return FALSE;
+	if (! InitializeSets (&outputs[1], 2, 800, 0.0, 10.0, 0.0)) return FALSE;
+	if (! InitializeSets (&outputs[2], 3, 1000, 0.0, 100.0, 0.0)) return FALSE;
+
+	Fuzzification (&inputs[0][0], TRIANGULAR, 5.0, 5.0, 28.0);
+	Fuzzification (&inputs[0][1], TRIANGULAR, 25.0, 28.5, 35.0);
+	Fuzzification (&inputs[0][2], TRAPEZOIDAL, 30.0, 40.0, 45.0, 45.0);
+
+	Fuzzification (&inputs[1][0], TRIANGULAR, 0.0, 0.0, 50.0);
+	Fuzzification (&inputs[1][1], GAUSSIAN, 50.0, 15.0);
+	Fuzzification (&inputs[1][2], TRIANGULAR, 50.0, 100.0, 100.0);
+
+	Fuzzification (&inputs[2][0], TRIANGULAR, 0.0, 0.0, 7.0);
+	Fuzzification (&inputs[2][1], TRIANGULAR, 3.0, 10.0, 10.0);
+
+	Fuzzification (&outputs[0][0], TRIANGULAR, 0.0, 0.0, 20.0);
+	Fuzzification (&outputs[0][1], TRIANGULAR, 20.0, 40.0, 70.0);
+	Fuzzification (&outputs[0][2], TRIANGULAR, 50.0, 100.0, 100.0);
+
+	Fuzzification (&outputs[1][0], TRIANGULAR, 0.0, 0.0, 6.0);
+	Fuzzification (&outputs[1][1], GAUSSIAN, 7.0, 2.0);
+
+	Fuzzification (&outputs[2][0], TRIANGULAR, 0.0, 0.0, 20.0);
+	Fuzzification (&outputs[2][1], TRIANGULAR, 20.0, 40.0, 70.0);
+	Fuzzification (&outputs[2][2], TRAPEZOIDAL, 50.0, 60.0, 100.0, 100.0);
+
+	return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void SetCheckRule (int k, int op, double weight, int output, int membership, int nantecedents,
+						  int input1, int term1, int input2, int term2, int input3, int term3)
+{
+	struct SCheckRule *rule = &check_rules[k];
+
+	rule->op = op;
+	rule->weight = weight;
+	rule->output = output;
+	rule->membership = membership;
+	rule->nantecedents = nantecedents;
+	rule->input[0] = input1;
+	rule->term[0] = term1;
+	rule->input[1] = input2;
+	rule->term[1] = term2;
+	rule->input[2] = input3;
+	rule->term[2] = term3;
+
+	return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// every pair of temperature and humidity terms drives duty and lin (AND and OR alternated, lin with
+// weight 0.7), plus a three input rule and a one input rule on the fan
+static void InitializeRules (void)
+{
+	int a;
+	int b;
+	int k = 0;
+
+	for (a = 0; a < 3; a++)
+	{
+		for (b = 0; b < 3; b++)
+		{
+			SetCheckRule (k++, ((a + b) % 2) ? OR : AND, 1.0, 0, (a + b) % 3, 2, 0, a, 1, b, 0, 0);
+			SetCheckRule (k++, ((a + b) % 2) ? AND : OR, 0.7, 2, (a * b) % 3, 2, 0, a, 1, b, 0, 0);
+		}
+	}
+
+	SetCheckRule (k++, AND, 0.5, 1, 0, 3, 0, 0, 1, 2, 2, 1);
+	SetCheckRule (k++, OR, 1.0, 1, 1, 1, 2, 0, 0, 0, 0, 0);
+
+	return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static struct SRuleBase *BuildRuleBase (int method, int defuzzy)
+{
+	int i;
+	struct SRuleBase *rules;
+
+	if (! InitializeRuleBase (&rules, NINPUTS, NOUTPUTS, method)) return NULL;
+
+	for (i = 0; i < NINPUTS; i++) SetRuleInput (rules, i, inputs[i]);
+	for (i = 0; i < NOUTPUTS; i++) SetRuleOutput (rules, i, outputs[i], defuzzy);
+
+	for (i = 0; i < NRULES; i++)
+	{
+		const struct SCheckRule *rule = &check_rules[i];
+
+		AddRuleArray (rules, rule->op, rule->weight, rule->output, rule->membership, rule->nantecedents, rule->input, rule->term);
+	}
+
+	if (! CompileRuleBase (rules))
+	{
+		FreeRuleBase (rules);
+		return NULL;
+	}
+
+	return rules;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// degree of a set in double: the tables hold point i at start_uod + i * step, read at the point
+// UniversePosDisc () rounds to
+static double ReferenceDegree (const struct SSets *set, double crisp)
+{
+	if (set->mode == MEMBERSHIP_ANALYTIC) return MembershipValue (set->type, set->params, crisp);
+
+	return MembershipValue (set->type, set->params, set->start_uod + (double) UniversePosDisc (set->universe, crisp) * set->universe->step);
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static double Implication (double membership, double alpha, int method)
+{
+	double value;
+
+	if (method == LARSEN) return alpha * membership;
+
+	value = (membership < alpha) ? membership : alpha;
+	if (method == ZADEH) value = (value > 1.0 - alpha) ? value : 1.0 - alpha;
+
+	return value;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// the rule base in double: strongest (and for ZADEH weakest) rule of each consequent, aggregated by
+// max on the discretization points and defuzzified with the point i at start_uod + i * step.
+// Any output in [lows[i], highs[i]] is right: they only differ when BOA ties (the area reaches exactly
+// half of the total at a point, the rounding of the sums picks that point or the next one)
+static void Reference (const double *crisp, int method, int defuzzy, double **aggregate, double *lows, double *highs)
+{
+	int i;
+	int j;
+	int k;
+	int a;
+	long p;
+	double alpha;
+	double degree;
+	double strongest[NOUTPUTS][3];
+	double weakest[NOUTPUTS][3];
+
+	for (i = 0; i < NOUTPUTS; i++)
+	{
+		for (j = 0; j < 3; j++)
+		{
+			strongest[i][j] = -HUGE_VAL;
+			weakest[i][j] = HUGE_VAL;
+		}
+	}
+
+	for (k = 0; k < NRULES; k++)
+	{
+		const struct SCheckRule *rule = &check_rules[k];
+
+		alpha = ReferenceDegree (&inputs[rule->input[0]][rule->term[0]], crisp[rule->input[0]]);
+
+		for (a = 1; a < rule->nantecedents; a++)
+		{
+			degree = ReferenceDegree (&inputs[rule->input[a]][rule->term[a]], crisp[rule->input[a]]);
+
+			if (rule->op == AND) alpha = (degree < alpha) ? degree : alpha;
+			else alpha = (degree > alpha) ? degree : alpha;
+		}
+
+		alpha = alpha * rule->weight;
+
+		if (alpha > strongest[rule->output][rule->membership]) strongest[rule->output][rule->membership] = alpha;
+		if (alpha < weakest[rule->output][rule->membership]) weakest[rule->output][rule->membership] = alpha;
+	}
+
+	for (i = 0; i < NOUTPUTS; i++)
+	{
+		const struct SSets *output = outputs[i];
+		long npoints = output[0].npoints;
+		double step = output[0].universe->step;
+		long double sum = 0;
+		long double moment = 0;
+		long double max_moment = 0;
+		double max = 0;
+		long first_max = 0;
+		long last_max = 0;
+		long nmax = 0;
+
+		for (p = 0; p < npoints; p++)
+		{
+			double x = output[0].start_uod + (double) p * step;
+			double value = 0;
+
+			for (j = 0; j < output[0].nsets; j++)
+			{
+				double membership;
+
+				if (strongest[i][j] == -HUGE_VAL) continue;
+
+				// MANDANI and LARSEN only write the points with a membership over 0 (alpha may be 0)
+				membership = MembershipValue (output[j].type, output[j].params, x);
+				if ((method != ZADEH) && ((! (membership > 0)) || (! (strongest[i][j] > 0)))) continue;
+
+				degree = Implication (membership, strongest[i][j], method);
+				if (degree > value) value = degree;
+
+				degree = Implication (membership, weakest[i][j], method);
+				if (degree > value) value = degree;
+			}
+
+			aggregate[i][p] = value;
+
+			sum += value;
+			moment += (long double) value * (long double) p;
+
+			if (value > max)
+			{
+				max = value;
+				first_max = p;
+				nmax = 0;
+				max_moment = 0;
+			}
+
+			if ((value == max) && (value > 0))
+			{
+				last_max = p;
+				nmax++;
+				max_moment += (long double) p;
+			}
+		}
+
+		// no rule fired: the aggregated output is empty
+		if (! (sum > 0))
+		{
+			lows[i] = 0;
+			highs[i] = 0;
+			continue;
+		}
+
+		switch (defuzzy)
+		{
+			case COA:	lows[i] = output[0].start_uod + (double) (moment / sum) * step;
+						break;
+
+			case MOM:	lows[i] = output[0].start_uod + (double) (max_moment / (long double) nmax) * step;
+						break;
+
+			case FOM:	lows[i] = UniverseDiscPos (output[0].universe, first_max);
+						break;
+
+			case LOM:	lows[i] = UniverseDiscPos (output[0].universe, last_max);
+						break;
+
+			// first point where the area on its left reaches half of the total area
+			case BOA:	{
+							long double left = 0;
+							long low = -1;
+
+							for (p = 0; p < npoints - 1; p++)
+							{
+								left += aggregate[i][p];
+								if ((low < 0) && (left >= (sum / 2) * (1 - BOA_TIE))) low = p;
+								if (left >= (sum / 2) * (1 + BOA_TIE)) break;
+							}
+
+							if (low < 0) low = p;
+
+							lows[i] = UniverseDiscPos (output[0].universe, low);
+							highs[i] = UniverseDiscPos (output[0].universe, p);
+						}
+						continue;
+		}
+
+		highs[i] = lows[i];
+	}
+
+	return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int main (int argc, char **argv)
+{
+	int m;
+	int d;
+	int i;
+	int level;
+	int nlevels;
+	long k;
+	int failed = 0;
+
+	static double columns[NINPUTS][NSAMPLES];
+	static double results[3][NOUTPUTS][NSAMPLES];
+
+	double *aggregate[NOUTPUTS];
+
+	if (! InitializeVariables ()) return 1;
+	InitializeRules ();
+
+	for (i = 0; i < NOUTPUTS; i++)
+	{
+		aggregate[i] = (double *) malloc (sizeof (double) * outputs[i][0].npoints);
+		if (aggregate[i] == NULL) return 1;
+	}
+
+	// random samples, temperature and humidity a bit out of their universes (clamped)
+	srand (3);
+	for (k = 0; k < NSAMPLES; k++)
+	{
+		columns[0][k] = 2.0 + 46.0 * rand () / RAND_MAX;
+		columns[1][k] = -3.0 + 106.0 * rand () / RAND_MAX;
+		columns[2][k] = 10.0 * rand () / RAND_MAX;
+	}
+
+	// levels the CPU does not support run as the best one it has, compared all the same
+	nlevels = SetKernelLevel (KERNEL_AVX2) + 1;
+
+	printf ("fuzzy_t of %d bytes, %d kernel levels\n", (int) sizeof (fuzzy_t), nlevels);
+
+	for (m = 0; m < (int) (sizeof (methods) / sizeof (methods[0])); m++)
+	{
+		for (d = 0; d < (int) (sizeof (defuzzifiers) / sizeof (defuzzifiers[0])); d++)
+		{
+			double worst[NOUTPUTS] = { 0, 0, 0 };
+			double bound[NOUTPUTS];
+
+			for (i = 0; i < NOUTPUTS; i++)
+			{
+				double range = outputs[i][0].stop_uod - outputs[i][0].start_uod;
+
+				switch (defuzzifiers[d])
+				{
+					case COA:	bound[i] = COA_RANGE * range;
+								break;
+
+					case MOM:
+					case FOM:
+					case LOM:	bound[i] = (MAXIMUM_STEPS + STEP_SLACK) * outputs[i][0].universe->step;
+								break;
+
+					default:	bound[i] = 0;
+								break;
+				}
+			}
+
+			for (level = 0; level < nlevels; level++)
+			{
+				struct SRuleBase *rules;
+
+				SetKernelLevel (level);
+
+				rules = BuildRuleBase (methods[m], defuzzifiers[d]);
+				if (rules == NULL) return 1;
+
+				for (k = 0; k < NSAMPLES; k++)
+				{
+					double crisp[NINPUTS];
+					double evaluated[NOUTPUTS];
+
+					for (i = 0; i < NINPUTS; i++) crisp[i] = columns[i][k];
+
+					if (! Evaluate (rules, crisp, evaluated)) return 1;
+
+					for (i = 0; i < NOUTPUTS; i++) results[level][i][k] = evaluated[i];
+				}
+
+				FreeRuleBase (rules);
+			}
+
+			for (k = 0; k < NSAMPLES; k++)
+			{
+				double crisp[NINPUTS];
+				double lows[NOUTPUTS];
+				double highs[NOUTPUTS];
+
+				for (i = 0; i < NINPUTS; i++) crisp[i] = columns[i][k];
+
+				Reference (crisp, methods[m], defuzzifiers[d], aggregate, lows, highs);
+
+				for (i = 0; i < NOUTPUTS; i++)
+				{
+					double diff = 0;
+
+					if (results[0][i][k] < lows[i]) diff = lows[i] - results[0][i][k];
+					if (results[0][i][k] > highs[i]) diff = results[0][i][k] - highs[i];
+					if (results[0][i][k] != results[0][i][k]) diff = results[0][i][k];
+
+					if (diff > worst[i]) worst[i] = diff;
+
+					// NaN fails too
+					if (! (diff <= bound[i]))
+					{
+						if (failed < 20)
+							printf ("\nError: %s %s output %d sample %ld: %.12g, double reference %.12g\n",
+									method_names[m], defuzzifier_names[d], i, k, results[0][i][k], lows[i]);
+						failed++;
+					}
+
+					for (level = 1; level < nlevels; level++)
+					{
+						if (results[level][i][k] != results[0][i][k])
+						{
+							if (failed < 20)
+								printf ("\nError: %s %s output %d sample %ld: %s kernels give %.17g, scalar %.17g\n",
+										method_names[m], defuzzifier_names[d], i, k, level_names[level],
+										results[level][i][k], results[0][i][k]);
+							failed++;
+						}
+					}
+				}
+			}
+
+			printf ("%-8s %-4s worst |diff| / range:", method_names[m], defuzzifier_names[d]);
+			for (i = 0; i < NOUTPUTS; i++) printf ("  %.3g", worst[i] / (outputs[i][0].stop_uod - outputs[i][0].start_uod));
+			printf ("\n");
+		}
+	}
+
+	SetKernelLevel (KERNEL_AVX2);
+
+	for (i = 0; i < NOUTPUTS; i++) free (aggregate[i]);
+	for (i = 0; i < NINPUTS; i++) FreeSets (inputs[i]);
+	for (i = 0; i < NOUTPUTS; i++) FreeSets (outputs[i]);
+
+	if (failed)
+	{
+		printf ("\ncheck_precision: %d differences out of the bound\n", failed);
+		return 1;
+	}
+
+	printf ("\ncheck_precision: ok\n");
+	return 0;
+}
@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "openfuzz.h"
+
+// Checks that a rule base follows its input sets when they are given to Fuzzification () again after
+// CompileRuleBase (): Evaluate () and EvaluateState () must give the same outputs as a rule base
+// compiled after the change (MANDANI, LARSEN and TSK use the support index of the inputs).
+// Run by "make check", returns 1 if an output differs.
+
+#define NSAMPLES	2001
+
+// the same order of operations on both rule bases
+#define TOLERANCE	1e-12
+
+static const int methods[] = { MANDANI, LARSEN, TSK };
+static const char *method_names[] = { "MANDANI", "LARSEN", "TSK" };
+
+// TSK: one constant per consequent term
+static const double sugeno[3] = { 10.0, 45.0, 90.0 };
+
+//-------------------------------------------------------------------------------------------------
+static struct SRuleBase *BuildRuleBase (int method, struct SSets *temperature, struct SSets *control)
+{
+	int i;
+	struct SRuleBase *rules;
+
+	if (! InitializeRuleBase (&rules, 1, 1, method)) return NULL;
+
+	SetRuleInput (rules, 0, temperature);
+
+	if (method == TSK) SetSugenoOutput (rules, 0, 3, 0, sugeno);
+	else SetRuleOutput (rules, 0, control, COA);
+
+	// cold -> min, warm -> med, hot -> max
+	for (i = 0; i < 3; i++) AddRule (rules, AND, 1.0, 0, i, 1, 0, i);
+
+	if (! CompileRuleBase (rules))
+	{
+		FreeRuleBase (rules);
+		return NULL;
+	}
+
+	return rules;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// outputs of the rule base compiled before the change against a rule base compiled now
+static int Compare (struct SRuleBase *rules, struct SRuleState *state, int m, struct SSets *temperature, struct SSets *control,
+					const char *step)
+{
+	int k;
+	int failed = 0;
+	double x;
+	double fresh;
+	double evaluated;
+	double stated;
+	double worst = 0;
+
+	struct SRuleBase *reference;
+
+	reference = BuildRuleBase (methods[m], temperature, control);
+	if (reference == NULL) return 1;
+
+	for (k = 0; k < NSAMPLES; k++)
+	{
+		x = -5.0 + 110.0 * (double) k / (double) (NSAMPLES - 1);
+
+		// EvaluateState () first: it must not depend on Evaluate () rebuilding the index
+		if ((! EvaluateState (rules, state, &x, &stated)) || (! Evaluate (rules, &x, &evaluated)) || (! Evaluate (reference, &x, &fresh)))
+		{
+			FreeRuleBase (reference);
+			return 1;
+		}
+
+		if (fabs (stated - fresh) > worst) worst = fabs (stated - fresh);
+		if (fabs (evaluated - fresh) > worst) worst = fabs (evaluated - fresh);
+
+		// NaN fails too
+		if ((! (fabs (stated - fresh) <= TOLERANCE)) || (! (fabs (evaluated - fresh) <= TOLERANCE)))
+		{
+			if (failed < 10)
+				printf ("\nError: %s %s temperature %g: Evaluate () %.12g, EvaluateState () %.12g, compiled again %.12g\n",
+						method_names[m], step, x, evaluated, stated, fresh);
+			failed++;
+		}
+	}
+
+	printf ("%-8s %-24s worst |diff| %.3g\n", method_names[m], step, worst);
+
+	FreeRuleBase (reference);
+
+	return failed;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int main (int argc, char **argv)
+{
+	int m;
+	int failed = 0;
+
+	struct SSets *temperature;
+	struct SSets *control;
+	struct SRuleBase *rules;
+	struct SRuleState *state;
+
+	if (! InitializeSets (&control, 3, 1000, 0.0, 100.0, 0.0)) return 1;
+
+	Fuzzification (&control[0], TRIANGULAR, 0.0, 0.0, 20.0);
+	Fuzzification (&control[1], TRIANGULAR, 20.0, 40.0, 70.0);
+	Fuzzification (&control[2], TRIANGULAR, 50.0, 100.0, 100.0);
+
+	for (m = 0; m < (int) (sizeof (methods) / sizeof (methods[0])); m++)
+	{
+		if (! InitializeSets (&temperature, 3, 1000, 0.0, 100.0, 0.0)) return 1;
+
+		Fuzzification (&temperature[0], TRIANGULAR, 5.0, 5.0, 28.0);
+		Fuzzification (&temperature[1], TRIANGULAR, 25.0, 28.5, 35.0);
+		Fuzzification (&temperature[2], TRIANGULAR, 30.0, 45.0, 45.0);
+
+		rules = BuildRuleBase (methods[m], temperature, control);
+		if (rules == NULL) return 1;
+
+		if (! InitializeRuleState (&state, rules)) return 1;
+
+		failed += Compare (rules, state, m, temperature, control, "as compiled");
+
+		// cold moved to peak at 70: far from its old support, a stale index never fires it there
+		Fuzzification (&temperature[0], TRIANGULAR, 60.0, 70.0, 80.0);
+		failed += Compare (rules, state, m, temperature, control, "cold moved to 70");
+
+		// two sets of the same input, one of them to another shape
+		Fuzzification (&temperature[1], TRAPEZOIDAL, 0.0, 0.0, 10.0, 50.0);
+		Fuzzification (&temperature[2], GAUSSIAN, 90.0, 5.0);
+		failed += Compare (rules, state, m, temperature, control, "warm and hot changed");
+
+		// back to the compiled shape
+		Fuzzification (&temperature[0], TRIANGULAR, 5.0, 5.0, 28.0);
+		Fuzzification (&temperature[1], TRIANGULAR, 25.0, 28.5, 35.0);
+		Fuzzification (&temperature[2], TRIANGULAR, 30.0, 45.0, 45.0);
+		failed += Compare (rules, state, m, temperature, control, "back as compiled");
+
+		FreeRuleState (state);
+		FreeRuleBase (rules);
+		FreeSets (temperature);
+	}
+
+	FreeSets (control);
+
+	if (failed)
+	{
+		printf ("\ncheck_retune: %d outputs differ\n", failed);
+		return 1;
+	}
+
+	printf ("\ncheck_retune: ok\n");
+	return 0;
+}
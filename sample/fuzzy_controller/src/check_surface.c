@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "openfuzz.h"
+
+// Checks the control surface of the sample controller (temperature -> duty cycle, MANDANI, COA) against the
+// rule base it was compiled from: EvaluateSurface () must give Evaluate () on every node and stay within the
+// max_error reported by CompileSurface () at random points off the grid (and out of the universe, where both
+// clamp). max_error is measured on 64 points per cell, a random point can be a bit farther (ESTIMATE_SLACK).
+// A refinement stopped by max_nodes must return SURFACE_COARSE, a target_error of 0 must keep the initial
+// resolution.
+// Run by "make check", returns 1 if a difference is out of the bound.
+
+// temperature
+#define TEMP_COLD	0
+#define TEMP_WARM	1
+#define TEMP_HOT	2
+
+// controller
+#define	CONTROL_MIN 0
+#define	CONTROL_MED 1
+#define	CONTROL_MAX 2
+
+#define DISCRETE_PTS 10000
+
+#define RESOLUTION	9
+#define TARGET_ERROR	0.5
+#define MAX_NODES	100000
+
+#define NSAMPLES	100000
+
+// the node outputs are the Evaluate () outputs, only the interpolation weights (0 or 1) can round
+#define NODE_TOLERANCE	1e-12
+
+// relative to max_error: between two measured points the error can still grow a little
+#define ESTIMATE_SLACK	0.01
+
+//-------------------------------------------------------------------------------------------------
+static struct SRuleBase *BuildRuleBase (struct SSets *temperature, struct SSets *control)
+{
+	int i;
+	struct SRuleBase *rules;
+
+	if (! InitializeRuleBase (&rules, 1, 1, MANDANI)) return NULL;
+
+	SetRuleInput (rules, 0, temperature);
+	SetRuleOutput (rules, 0, control, COA);
+
+	// cold -> min, warm -> med, hot -> max
+	for (i = 0; i < 3; i++) AddRule (rules, AND, 1.0, 0, i, 1, 0, i);
+
+	if (! CompileRuleBase (rules))
+	{
+		FreeRuleBase (rules);
+		return NULL;
+	}
+
+	return rules;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int CheckSurface (struct SSurface *surface, struct SRuleBase *rules, double start_uod, double stop_uod)
+{
+	long k;
+	int failed = 0;
+	double x;
+	double exact;
+	double approx;
+	double diff;
+	double worst_node = 0;
+	double worst = 0;
+	double range = stop_uod - start_uod;
+
+	// nodes
+	for (k = 0; k < surface->resolution[0]; k++)
+	{
+		x = start_uod + range * k / (surface->resolution[0] - 1);
+
+		if (! Evaluate (rules, &x, &exact)) return 1;
+		EvaluateSurface (surface, &x, &approx);
+
+		diff = fabs (exact - approx);
+		if (diff > worst_node) worst_node = diff;
+
+		// NaN fails too
+		if (! (diff <= NODE_TOLERANCE * range))
+		{
+			if (failed < 20) printf ("\nError: node %ld (%.12g): EvaluateSurface () gives %.12g, Evaluate () %.12g\n", k, x, approx, exact);
+			failed++;
+		}
+	}
+
+	// random points, 10% of them out of the universe
+	srand (1);
+
+	for (k = 0; k < NSAMPLES; k++)
+	{
+		x = start_uod - 0.05 * range + 1.1 * range * ((double) rand () / (double) RAND_MAX);
+
+		if (! Evaluate (rules, &x, &exact)) return 1;
+		EvaluateSurface (surface, &x, &approx);
+
+		diff = fabs (exact - approx);
+		if (diff > worst) worst = diff;
+
+		if (! (diff <= (1.0 + ESTIMATE_SLACK) * surface->max_error))
+		{
+			if (failed < 20)
+				printf ("\nError: sample %ld (%.12g): EvaluateSurface () gives %.12g, Evaluate () %.12g, max_error %.12g\n",
+						k, x, approx, exact, surface->max_error);
+			failed++;
+		}
+	}
+
+	printf ("%d nodes, max_error %.6g, worst |diff|: nodes %.3g  random points %.6g\n",
+			surface->resolution[0], surface->max_error, worst_node, worst);
+
+	return failed;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int main (int argc, char **argv)
+{
+	int failed = 0;
+	int status;
+	int resolution[1] = { RESOLUTION };
+
+	struct SSets *temperature;
+	struct SSets *control;
+	struct SRuleBase *rules;
+	struct SSurface *surface;
+
+	if (! InitializeSets (&temperature, 3, DISCRETE_PTS, 5.0, 45.0, 0.0)) return 1;
+	if (! InitializeSets (&control, 3, DISCRETE_PTS, 0.0, 100.0, 0.0)) return 1;
+
+	Fuzzification (&temperature[TEMP_COLD], TRIANGULAR, 5.0, 5.0, 28.0);
+	Fuzzification (&temperature[TEMP_WARM], TRIANGULAR, 25.0, 28.5, 35.0);
+	Fuzzification (&temperature[TEMP_HOT], TRIANGULAR, 30.0, 45.0, 45.0);
+
+	Fuzzification (&control[CONTROL_MIN], TRIANGULAR, 0.0, 0.0, 20.0);
+	Fuzzification (&control[CONTROL_MED], TRIANGULAR, 20.0, 40.0, 70.0);
+	Fuzzification (&control[CONTROL_MAX], TRIANGULAR, 50.0, 100.0, 100.0);
+
+	rules = BuildRuleBase (temperature, control);
+	if (rules == NULL) return 1;
+
+	// refined until TARGET_ERROR
+	status = CompileSurface (&surface, rules, resolution, TARGET_ERROR, MAX_NODES);
+	if (status != TRUE)
+	{
+		printf ("\nError: CompileSurface () returns %d, TRUE expected\n", status);
+		return 1;
+	}
+
+	if (! (surface->max_error <= TARGET_ERROR))
+	{
+		printf ("\nError: max_error %.12g bigger than the target %.12g\n", surface->max_error, TARGET_ERROR);
+		failed++;
+	}
+
+	failed += CheckSurface (surface, rules, 5.0, 45.0);
+	FreeSurface (surface);
+
+	// target error 0: the initial resolution
+	status = CompileSurface (&surface, rules, resolution, 0.0, MAX_NODES);
+	if ((status != TRUE) || (surface->resolution[0] != RESOLUTION))
+	{
+		printf ("\nError: target error 0: CompileSurface () returns %d with %d nodes, TRUE with %d expected\n",
+				status, status ? surface->resolution[0] : 0, RESOLUTION);
+		return 1;
+	}
+
+	failed += CheckSurface (surface, rules, 5.0, 45.0);
+	FreeSurface (surface);
+
+	// a target that needs more than 2 * RESOLUTION - 2 nodes, stopped there
+	status = CompileSurface (&surface, rules, resolution, 1e-9, 2 * RESOLUTION - 2);
+	if ((status != SURFACE_COARSE) || (surface->resolution[0] != RESOLUTION) || (! (surface->max_error > 1e-9)))
+	{
+		printf ("\nError: max_nodes %d: CompileSurface () returns %d with %d nodes, SURFACE_COARSE with %d expected\n",
+				2 * RESOLUTION - 2, status, status ? surface->resolution[0] : 0, RESOLUTION);
+		return 1;
+	}
+
+	failed += CheckSurface (surface, rules, 5.0, 45.0);
+	FreeSurface (surface);
+
+	FreeRuleBase (rules);
+	FreeSets (temperature);
+	FreeSets (control);
+
+	if (failed)
+	{
+		printf ("\ncheck_surface: %d differences out of the bound\n", failed);
+		return 1;
+	}
+
+	printf ("check_surface: ok\n");
+
+	return 0;
+}
+//-------------------------------------------------------------------------------------------------
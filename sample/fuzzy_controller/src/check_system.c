@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "openfuzz.h"
+#include "openfuzz.hpp"
+
+// Checks the sample controller written as an openfuzz::FuzzySystem (constexpr, tables computed by the
+// compiler) against the same rules in a C rule base (Evaluate () with MEMBERSHIP_ANALYTIC temperature
+// sets and a duty cycle of DISCRETE_PTS points), for MANDANI, LARSEN and ZADEH with COA, MOM, FOM and
+// LOM, over the whole temperature range:
+//   COA                within 1e-6 of the output range (the template aggregates in double)
+//   MOM, FOM and LOM   within one discretization step (rounding can change which points tie at the
+//                      maximum)
+// Run by "make check", returns 1 if a difference is out of the bound.
+
+// temperature
+#define TEMP_COLD	0
+#define TEMP_WARM	1
+#define TEMP_HOT	2
+
+// controller
+#define	CONTROL_MIN 0
+#define	CONTROL_MED 1
+#define	CONTROL_MAX 2
+
+#define DISCRETE_PTS 10000
+
+#define NSAMPLES	4401
+
+#define COA_RANGE	1e-6
+#define MAXIMUM_STEPS	1.0
+
+// two points one step apart can be a few ulp more than the step away
+#define STEP_SLACK	1e-9
+
+typedef openfuzz::Variable<openfuzz::Triangle, openfuzz::Triangle, openfuzz::Triangle> Temperature;
+typedef openfuzz::Variable<openfuzz::Triangle, openfuzz::Triangle, openfuzz::Triangle> DutyCycle;
+
+typedef openfuzz::Rules<openfuzz::Rule<openfuzz::Is<0, TEMP_COLD>, CONTROL_MIN>,
+						openfuzz::Rule<openfuzz::Is<0, TEMP_WARM>, CONTROL_MED>,
+						openfuzz::Rule<openfuzz::Is<0, TEMP_HOT>, CONTROL_MAX> > ControllerRules;
+
+template <typename Implication, typename Defuzzifier>
+using Controller = openfuzz::FuzzySystem<std::tuple<Temperature>, DutyCycle, ControllerRules, openfuzz::MinMax, Implication, Defuzzifier,
+										 DISCRETE_PTS>;
+
+static constexpr Temperature temperature_variable (5.0, 45.0,
+												   openfuzz::Triangle (5.0, 5.0, 28.0),
+												   openfuzz::Triangle (25.0, 28.5, 35.0),
+												   openfuzz::Triangle (30.0, 45.0, 45.0));
+
+static constexpr DutyCycle dutycycle_variable (0.0, 100.0,
+											   openfuzz::Triangle (0.0, 0.0, 20.0),
+											   openfuzz::Triangle (20.0, 40.0, 70.0),
+											   openfuzz::Triangle (50.0, 100.0, 100.0));
+
+// one system per implication and defuzzifier, tables in read only memory
+template <typename Implication, typename Defuzzifier>
+static constexpr Controller<Implication, Defuzzifier> controller (std::make_tuple (temperature_variable), dutycycle_variable);
+
+//-------------------------------------------------------------------------------------------------
+template <typename Implication, typename Defuzzifier>
+static int Compare (int method, const char *method_name, int defuzzy, const char *defuzzy_name, struct SSets *temperature,
+					struct SSets *control)
+{
+	int i;
+	int failed = 0;
+	long k;
+	double bound;
+	double worst = 0;
+	double range = control[0].stop_uod - control[0].start_uod;
+
+	struct SRuleBase *rules;
+
+	if (! InitializeRuleBase (&rules, 1, 1, method)) return 1;
+
+	SetRuleInput (rules, 0, temperature);
+	SetRuleOutput (rules, 0, control, defuzzy);
+
+	// cold -> min, warm -> med, hot -> max
+	for (i = 0; i < 3; i++) AddRule (rules, AND, 1.0, 0, i, 1, 0, i);
+
+	if (! CompileRuleBase (rules))
+	{
+		FreeRuleBase (rules);
+		return 1;
+	}
+
+	if (defuzzy == COA) bound = COA_RANGE * range;
+	else bound = (MAXIMUM_STEPS + STEP_SLACK) * control[0].universe->step;
+
+	for (k = 0; k < NSAMPLES; k++)
+	{
+		// a bit out of the universe on both sides
+		double x = 3.0 + 44.0 * (double) k / (double) (NSAMPLES - 1);
+		double evaluated;
+		double inferred;
+
+		if (! Evaluate (rules, &x, &evaluated))
+		{
+			FreeRuleBase (rules);
+			return 1;
+		}
+
+		inferred = controller<Implication, Defuzzifier> (x);
+
+		if (fabs (inferred - evaluated) > worst) worst = fabs (inferred - evaluated);
+
+		// NaN fails too
+		if (! (fabs (inferred - evaluated) <= bound))
+		{
+			if (failed < 10)
+				printf ("\nError: %s %s temperature %g: FuzzySystem %.12g, Evaluate () %.12g\n", method_name, defuzzy_name, x, inferred,
+						evaluated);
+			failed++;
+		}
+	}
+
+	printf ("%-8s %-4s worst |diff| / range %.3g\n", method_name, defuzzy_name, worst / range);
+
+	FreeRuleBase (rules);
+
+	return failed;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+template <typename Implication>
+static int CompareDefuzzifiers (int method, const char *method_name, struct SSets *temperature, struct SSets *control)
+{
+	int failed = 0;
+
+	failed += Compare<Implication, openfuzz::Centroid> (method, method_name, COA, "COA", temperature, control);
+	failed += Compare<Implication, openfuzz::MeanOfMaximum> (method, method_name, MOM, "MOM", temperature, control);
+	failed += Compare<Implication, openfuzz::FirstOfMaximum> (method, method_name, FOM, "FOM", temperature, control);
+	failed += Compare<Implication, openfuzz::LastOfMaximum> (method, method_name, LOM, "LOM", temperature, control);
+
+	return failed;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int main (int argc, char **argv)
+{
+	int failed = 0;
+
+	struct SSets *temperature;
+	struct SSets *control;
+
+	// the template computes exact input degrees: analytic temperature sets
+	if (! InitializeAnalyticSets (&temperature, 3, 5.0, 45.0)) return 1;
+	if (! InitializeSets (&control, 3, DISCRETE_PTS, 0.0, 100.0, 0.0)) return 1;
+
+	Fuzzification (&temperature[TEMP_COLD], TRIANGULAR, 5.0, 5.0, 28.0);
+	Fuzzification (&temperature[TEMP_WARM], TRIANGULAR, 25.0, 28.5, 35.0);
+	Fuzzification (&temperature[TEMP_HOT], TRIANGULAR, 30.0, 45.0, 45.0);
+
+	Fuzzification (&control[CONTROL_MIN], TRIANGULAR, 0.0, 0.0, 20.0);
+	Fuzzification (&control[CONTROL_MED], TRIANGULAR, 20.0, 40.0, 70.0);
+	Fuzzification (&control[CONTROL_MAX], TRIANGULAR, 50.0, 100.0, 100.0);
+
+	failed += CompareDefuzzifiers<openfuzz::Mandani> (MANDANI, "MANDANI", temperature, control);
+	failed += CompareDefuzzifiers<openfuzz::Larsen> (LARSEN, "LARSEN", temperature, control);
+	failed += CompareDefuzzifiers<openfuzz::Zadeh> (ZADEH, "ZADEH", temperature, control);
+
+	FreeSets (temperature);
+	FreeSets (control);
+
+	if (failed)
+	{
+		printf ("\ncheck_system: %d differences out of the bound\n", failed);
+		return 1;
+	}
+
+	printf ("\ncheck_system: ok\n");
+	return 0;
+}
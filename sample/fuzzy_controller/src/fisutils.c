@@ -37,25 +37,178 @@
  *
  */
 
+#include <stdint.h>
+
 #include "fisutils.h"
 
 
+// every set vector starts on its own cache line
+#define SETS_ALIGNMENT  64
+
 //-------------------------------------------------------------------------------------------------
-int InitializeSets (struct SSets **sets, int nsets, long npoints, double start_uod, double stop_uod, double value)
+static size_t AlignSize (size_t size)
+{
+    return (size + SETS_ALIGNMENT - 1) & ~((size_t) SETS_ALIGNMENT - 1);
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void SetupUniverse (struct SUniverse *universe, long npoints, double start_uod, double stop_uod)
+{
+    universe->npoints = npoints;
+    universe->start_uod = start_uod;
+    universe->stop_uod = stop_uod;
+    // point i is at start_uod + i * step (the last one is stop_uod - step), scale is 1 / step
+    universe->step = (stop_uod - start_uod) / (double) npoints;
+    universe->scale = (double) npoints / (stop_uod - start_uod);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// arena layout: [SSets array][SUniverse][set 0 vector][set 1 vector]...[set n-1 vector]
+// for MEMBERSHIP_INTERLEAVED the vectors are replaced by one [point][term] table
+static struct SSets *AllocateSets (int nsets, long npoints, int mode, double start_uod, double stop_uod)
 {
     long i;
-    long j;
+    int stride;
+    size_t head;
+    size_t vector;
+    size_t table;
+    void *raw;
+    char *base;
 
     struct SSets *aux;
+    struct SUniverse *universe = NULL;
 
-    aux = (struct SSets *) malloc (sizeof (struct SSets) * nsets);
-    if (aux == NULL) return FALSE;
+    // rows of 1, 2, 4 or 8 values never cross a cache line, bigger rows use whole lines
+    stride = 1;
+    while ((stride < nsets) && (stride < 8)) stride = stride * 2;
+    if (nsets > 8) stride = (nsets + 7) & ~7;
+
+    head = AlignSize (sizeof (struct SSets) * nsets);
+    vector = 0;
+    table = 0;
+
+    if (mode != MEMBERSHIP_ANALYTIC)
+        head = head + AlignSize (sizeof (struct SUniverse));
+
+    if (mode == MEMBERSHIP_TABLE)
+        vector = AlignSize (sizeof (fuzzy_t) * npoints);
+
+    if (mode == MEMBERSHIP_INTERLEAVED)
+        table = AlignSize (sizeof (fuzzy_t) * stride * npoints);
+
+    raw = malloc (head + vector * nsets + table + SETS_ALIGNMENT - 1);
+    if (raw == NULL) return NULL;
+
+    base = (char *) (((uintptr_t) raw + SETS_ALIGNMENT - 1) & ~((uintptr_t) SETS_ALIGNMENT - 1));
+    aux = (struct SSets *) base;
+
+    if (mode != MEMBERSHIP_ANALYTIC)
+    {
+        universe = (struct SUniverse *) (base + AlignSize (sizeof (struct SSets) * nsets));
+        SetupUniverse (universe, npoints, start_uod, stop_uod);
+    }
 
     for (i = 0; i < nsets; i++)
     {
-        aux[i].value = (double *) malloc (sizeof (double) * npoints);
-        if (aux[i].value == NULL) return FALSE;
+            aux[i].value = (mode == MEMBERSHIP_TABLE) ? (fuzzy_t *) (base + head + vector * i) : NULL;
+            aux[i].nsets = nsets;
+            aux[i].npoints = (mode == MEMBERSHIP_ANALYTIC) ? 0 : npoints;
+            aux[i].start_uod = start_uod;
+            aux[i].stop_uod = stop_uod;
+            aux[i].universe = universe;
+            aux[i].mode = mode;
+            aux[i].type = TRIANGULAR;
+            memset (aux[i].params, 0, sizeof (aux[i].params));
+            aux[i].arena = raw;
+            aux[i].degrees = (mode == MEMBERSHIP_INTERLEAVED) ? (fuzzy_t *) (base + head) : NULL;
+            aux[i].stride = (mode == MEMBERSHIP_INTERLEAVED) ? stride : 1;
+            aux[i].term = (int) i;
+            aux[i].revision = 0;
+    }
+
+    return aux;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void UpdateSupport (struct SSets *set)
+{
+    long stride;
+    const fuzzy_t *column;
+
+    if (set->mode == MEMBERSHIP_ANALYTIC)
+    {
+        set->first = 0;
+        set->last = -1;
+
+        switch (set->type)
+        {
+            case TRIANGULAR:    set->support_start = set->params[0];
+                                set->support_stop = set->params[2];
+                                break;
+
+            case TRAPEZOIDAL:   set->support_start = set->params[0];
+                                set->support_stop = set->params[3];
+                                break;
+
+            default:            set->support_start = -HUGE_VAL;
+                                set->support_stop = HUGE_VAL;
+                                break;
+        }
+
+        return;
+    }
+
+    if (set->mode == MEMBERSHIP_INTERLEAVED)
+    {
+        column = &set->degrees[set->term];
+        stride = set->stride;
     }
+    else
+    {
+        column = set->value;
+        stride = 1;
+    }
+
+    for (set->first = 0; set->first < set->npoints; set->first++)
+        if (column[set->first * stride] != 0) break;
+
+    for (set->last = set->npoints - 1; set->last >= set->first; set->last--)
+        if (column[set->last * stride] != 0) break;
+
+    if (set->first > set->last)
+    {
+        set->support_start = HUGE_VAL;
+        set->support_stop = -HUGE_VAL;
+        return;
+    }
+
+    // UniversePosDisc () rounds to the nearest point and clamps to the universe, so the interval
+    // is widened by one point and left open on the edges of the universe
+    if (set->first == 0) set->support_start = -HUGE_VAL;
+    else set->support_start = set->start_uod + ((double) set->first - 1.5) / set->universe->scale;
+
+    if (set->last == set->npoints - 1) set->support_stop = HUGE_VAL;
+    else set->support_stop = set->start_uod + ((double) set->last + 1.5) / set->universe->scale;
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int InitializeSets (struct SSets **sets, int nsets, long npoints, double start_uod, double stop_uod, double value)
+{
+    long i;
+    long j;
+
+    struct SSets *aux;
+
+    aux = AllocateSets (nsets, npoints, MEMBERSHIP_TABLE, start_uod, stop_uod);
+    if (aux == NULL) return FALSE;
 
     for (i = 0; i < nsets; i++)
     {
@@ -63,42 +216,80 @@ int InitializeSets (struct SSets **sets, int nsets, long npoints, double start_u
         {
             aux[i].value[j] = value;
         }
+
+        UpdateSupport (&aux[i]);
     }
 
-    for (i = 0; i < nsets; i++)
+    (* sets) = aux;
+
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int InitializeAnalyticSets (struct SSets **sets, int nsets, double start_uod, double stop_uod)
+{
+    int i;
+
+    struct SSets *aux;
+
+    aux = AllocateSets (nsets, 0, MEMBERSHIP_ANALYTIC, start_uod, stop_uod);
+    if (aux == NULL) return FALSE;
+
+    for (i = 0; i < nsets; i++) UpdateSupport (&aux[i]);
+
+    (* sets) = aux;
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int InitializeInterleavedSets (struct SSets **sets, int nsets, long npoints, double start_uod, double stop_uod, double value)
+{
+    long i;
+
+    struct SSets *aux;
+
+    aux = AllocateSets (nsets, npoints, MEMBERSHIP_INTERLEAVED, start_uod, stop_uod);
+    if (aux == NULL) return FALSE;
+
+    for (i = 0; i < npoints * aux[0].stride; i++)
     {
-            aux[i].nsets = nsets;
-            aux[i].npoints = npoints;
-            aux[i].start_uod = start_uod;
-            aux[i].stop_uod = stop_uod;
+        aux[0].degrees[i] = value;
     }
 
-    (* sets) = aux;
+    for (i = 0; i < nsets; i++) UpdateSupport (&aux[i]);
 
+    (* sets) = aux;
 
     return TRUE;
 }
 //-------------------------------------------------------------------------------------------------
 
+//-------------------------------------------------------------------------------------------------
+void FreeSets (struct SSets *sets)
+{
+    if (sets == NULL) return;
+
+    free (sets[0].arena);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
 
 //-------------------------------------------------------------------------------------------------
-double *MembershipFunction (int type, ...)
+fuzzy_t *MembershipFunction (int type, ...)
 {
-    double *aux;
+    fuzzy_t *aux;
     long int npoints;
     double start_uod;
     double stop_uod;
 
-    double x1;
-    double x2;
-    double x3;
-    double x4;
-    double center;
-    double sigma;
-
+    double params[4];
     double y;
-    double j;
-    long int i;
 
 
     va_list ap;
@@ -109,216 +300,289 @@ double *MembershipFunction (int type, ...)
 
     y = (stop_uod - start_uod) / npoints;
 
-
-    aux = (double *) malloc (sizeof (double) * npoints);
-    if (! aux)
-    {
-        printf ("\nError on allocating memory: MembershipFunction ()\n");
-        return FALSE;
-    }
+    memset (params, 0, sizeof (params));
 
     switch (type)
     {
-        case TRIANGULAR:    x1 = va_arg (ap, double);
-                            x2 = va_arg (ap, double);
-                            x3 = va_arg (ap, double);
-
-                            for (i = 0, j = start_uod; i < npoints; i++, j = j + y)
-                            {
-                                if (j < x1)
-                                {
-                                    aux[i] = 0;
-                                }
-
-                                else if ((j >= x1) && (j < x2))
-                                {
-                                    aux[i] = (j / (x2 - x1)) - (x1 / (x2 - x1));
-                                }
-
-                                else if ((j >= x2) && (j < x3))
-                                {
-                                    aux[i] = ((-j) / (x3 - x2)) + (x3 / (x3 - x2));
-                                }
-
-                                else if (j >= x3)
-                                {
-                                    aux[i] = 0;
-                                }
-                            }
+        case TRIANGULAR:    params[0] = va_arg (ap, double);   // x1
+                            params[1] = va_arg (ap, double);   // x2
+                            params[2] = va_arg (ap, double);   // x3
                             break;
 
-        case TRAPEZOIDAL:   x1 = va_arg (ap, double);
-                            x2 = va_arg (ap, double);
-                            x3 = va_arg (ap, double);
-                            x4 = va_arg (ap, double);
+        case TRAPEZOIDAL:   params[0] = va_arg (ap, double);   // x1
+                            params[1] = va_arg (ap, double);   // x2
+                            params[2] = va_arg (ap, double);   // x3
+                            params[3] = va_arg (ap, double);   // x4
+                            break;
 
-                            for (i = 0, j = start_uod; i < npoints; i++, j = j + y)
-                            {
-                                if (j < x1)
-                                {
-                                    aux[i] = 0;
-                                }
+        case GAUSSIAN:		params[0] = va_arg (ap, double);   // center
+                            params[1] = va_arg (ap, double);   // sigma
+                            //f(x) = A e ((-1/sigma^2)*(x - x0)^2)
+                            break;
+    }
 
-                                else if ((j >= x1) && (j < x2))
-                                {
-                                    aux[i] = (j / (x2 - x1))  - (x1 / (x2 - x1));
-                                }
+    va_end (ap);
 
-                                else if ((j >= x2) && (j < x3))
-                                {
-                                    aux[i] = 1;
-                                }
 
-                                else if ((j >= x3) && (j < x4))
-                                {
-                                    aux[i] = ((-j) / (x4 - x3)) + (x4 / (x4 - x3));
-                                }
+    aux = (fuzzy_t *) malloc (sizeof (fuzzy_t) * npoints);
+    if (! aux)
+    {
+        printf ("\nError on allocating memory: MembershipFunction ()\n");
+        return FALSE;
+    }
 
-                                else if (j >= x4)
-                                {
-                                    aux[i] = 0;
-                                }
-                            }
+    // point i is at start_uod + i * y (computed from the index, not accumulated)
+    MembershipKernel (aux, npoints, start_uod, y, type, params);
 
+    return aux;
 
-                            break;
+}
+//-------------------------------------------------------------------------------------------------
 
-        case GAUSSIAN:		center = va_arg (ap, double);
-                            sigma  = va_arg (ap, double);
 
-                            for (i = 0, j = start_uod; i < npoints; i++, j = j + y)
-                            {
-                                aux[i] = exp ((-1 / pow (sigma, 2)) * pow ((j - center), 2));
-                            //f(x) = A e ((-1/sigma^2)*(x - x0)^2)
-                            }
+// points generated per kernel call when filling an interleaved table
+#define INTERLEAVED_BLOCK   256
 
-                            break;
-    }
+//-------------------------------------------------------------------------------------------------
+static void InterleavedFuzzification (struct SSets *set)
+{
+    long i;
+    long j;
+    long n;
+    fuzzy_t block[INTERLEAVED_BLOCK];
+    fuzzy_t *row;
 
+    // the kernel fills a contiguous block, which is then scattered in the set column
+    for (i = 0; i < set->npoints; i = i + INTERLEAVED_BLOCK)
+    {
+        n = set->npoints - i;
+        if (n > INTERLEAVED_BLOCK) n = INTERLEAVED_BLOCK;
 
+        MembershipKernel (block, n, set->start_uod + (double) i * set->universe->step, set->universe->step, set->type, set->params);
 
-    return aux;
+        row = &set->degrees[i * set->stride + set->term];
+        for (j = 0; j < n; j++)
+        {
+            row[j * set->stride] = block[j];
+        }
+    }
 
+    return;
 }
 //-------------------------------------------------------------------------------------------------
 
-
 //-------------------------------------------------------------------------------------------------
 void Fuzzification (struct SSets *sets, int type, ...)
 {
-    double x1;
-    double x2;
-    double x3;
-    double x4;
-
-    double center;
-    double sigma;
-
     va_list ap;
     va_start (ap, type);
 
+    sets->type = type;
+    memset (sets->params, 0, sizeof (sets->params));
 
     switch (type)
     {
-        case TRIANGULAR:    x1 = va_arg (ap, double);
-                            x2 = va_arg (ap, double);
-                            x3 = va_arg (ap, double);
-                            sets->value = MembershipFunction (type, sets->npoints, sets->start_uod, sets->stop_uod, x1, x2, x3);
+        case TRIANGULAR:    sets->params[0] = va_arg (ap, double);
+                            sets->params[1] = va_arg (ap, double);
+                            sets->params[2] = va_arg (ap, double);
+                            break;
 
+        case TRAPEZOIDAL:   sets->params[0] = va_arg (ap, double);
+                            sets->params[1] = va_arg (ap, double);
+                            sets->params[2] = va_arg (ap, double);
+                            sets->params[3] = va_arg (ap, double);
                             break;
 
-        case TRAPEZOIDAL:   x1 = va_arg (ap, double);
-                            x2 = va_arg (ap, double);
-                            x3 = va_arg (ap, double);
-                            x4 = va_arg (ap, double);
-							sets->value = MembershipFunction (type, sets->npoints, sets->start_uod, sets->stop_uod, x1, x2, x3, x4);
+        case GAUSSIAN:		sets->params[0] = va_arg (ap, double);
+                            sets->params[1] = va_arg (ap, double);
                             break;
+    }
 
-        case GAUSSIAN:		center = va_arg (ap, double);
-                            sigma  = va_arg (ap, double);
-                            sets->value = MembershipFunction (type, sets->npoints, sets->start_uod, sets->stop_uod, center, sigma);
+    va_end (ap);
 
-                            break;
+    // analytic sets keep only the parameters, table sets are filled in place
+    switch (sets->mode)
+    {
+        case MEMBERSHIP_TABLE:          MembershipKernel (sets->value, sets->npoints, sets->start_uod, sets->universe->step, type, sets->params);
+                                        break;
+
+        case MEMBERSHIP_INTERLEAVED:    InterleavedFuzzification (sets);
+                                        break;
     }
 
+    UpdateSupport (sets);
+    sets->revision++;
+
     return;
 }
 //-------------------------------------------------------------------------------------------------
 
 //-------------------------------------------------------------------------------------------------
-long ConvPosDisc (double point, long npoints, double start_uod, double stop_uod)
+double MembershipValue (int type, const double *params, double point)
 {
-    long aprox;
-    double x;
-//    double aux = 0;
+    switch (type)
+    {
+        case TRIANGULAR:    if ((point >= params[0]) && (point < params[1]))
+                                return (point - params[0]) / (params[1] - params[0]);
 
-	// i = beginning of universe of discourse
-    // f = end of universe of discourse
-    // vi = start of array (alwasys 0)
-    // vf = end of array (always the number of points)
+                            if ((point >= params[1]) && (point < params[2]))
+                                return (params[2] - point) / (params[2] - params[1]);
 
-    // y = ((f - i) / (vf - vi)).x + (f - ((f - i) / (vf - vi)).vf)
-    //   shorting...:
-    // y = ((f - i) / (vf - vi).x ) + i))
+                            return 0;
 
-	// where y = analogic value (input of universe of discourse)
-    // and x = point of discretization array
+        case TRAPEZOIDAL:   if ((point >= params[0]) && (point < params[1]))
+                                return (point - params[0]) / (params[1] - params[0]);
 
-	// inverting the equation we have
-    // x = ((y - i).(vf)/(f-i)
+                            if ((point >= params[1]) && (point < params[2]))
+                                return 1;
 
-	// as the counting starts on zero.. numbers of points is = (total - 1)
+                            if ((point >= params[2]) && (point < params[3]))
+                                return (params[3] - point) / (params[3] - params[2]);
 
-	x = ((point - start_uod)* (npoints - 1)) / (stop_uod - start_uod);
+                            return 0;
 
-	aprox = (long) floor (x);
-    	x = x - (double) aprox;
-//	aux = aprox;
-	if (x >= 0.5)
-		aprox = aprox + 1;
+        case GAUSSIAN:		return exp (-((point - params[0]) * (point - params[0])) / (params[1] * params[1]));
+    }
 
+    return 0;
+}
+//-------------------------------------------------------------------------------------------------
 
-    return aprox;
+//-------------------------------------------------------------------------------------------------
+double MembershipDegree (const struct SSets *set, double point)
+{
+    switch (set->mode)
+    {
+        case MEMBERSHIP_ANALYTIC:       return MembershipValue (set->type, set->params, point);
+
+        case MEMBERSHIP_INTERLEAVED:    return set->degrees[UniversePosDisc (set->universe, point) * set->stride + set->term];
+    }
+
+    return set->value[UniversePosDisc (set->universe, point)];
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+const fuzzy_t *MembershipVector (const struct SSets *sets, double point)
+{
+    if (sets->mode != MEMBERSHIP_INTERLEAVED) return NULL;
+
+    return &sets->degrees[UniversePosDisc (sets->universe, point) * sets->stride];
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+long ConvPosDisc (double point, long npoints, double start_uod, double stop_uod)
+{
+    struct SUniverse universe;
+
+    // the same rounding and clamp as UniversePosDisc ()
+    SetupUniverse (&universe, npoints, start_uod, stop_uod);
+
+    return UniversePosDisc (&universe, point);
 }
 //-------------------------------------------------------------------------------------------------
 
 //-------------------------------------------------------------------------------------------------
 double ConvDiscPos  (long int disc, long npoints, double start_uod, double stop_uod)
 {
-    long int i;
-    double k;
-    double y;
-    double value;
+    struct SUniverse universe;
+
+    SetupUniverse (&universe, npoints, start_uod, stop_uod);
+
+    return UniverseDiscPos (&universe, disc);
+}
+//-------------------------------------------------------------------------------------------------
 
-    y = (double) (stop_uod - start_uod) / (double) npoints;
+//-------------------------------------------------------------------------------------------------
+int InitializeUniverse (struct SUniverse **universe, long npoints, double start_uod, double stop_uod)
+{
+    struct SUniverse *aux;
+
+    aux = (struct SUniverse *) malloc (sizeof (struct SUniverse));
+    if (aux == NULL) return FALSE;
 
-    for (i = 0, k = 0; i <= disc; i++, k = k + y);
+    SetupUniverse (aux, npoints, start_uod, stop_uod);
 
-    value = start_uod + k;
+    (* universe) = aux;
 
-    return value;
+    return TRUE;
 }
+//-------------------------------------------------------------------------------------------------
 
-//------------------------------------------------------------------------------
-double *SigletonSet (double point, long npoints, double start_uod, double stop_uod)
+//-------------------------------------------------------------------------------------------------
+void FreeUniverse (struct SUniverse *universe)
+{
+    if (universe == NULL) return;
+
+    free (universe);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+long UniversePosDisc (const struct SUniverse *universe, double point)
 {
-    double *aux;
+    double x;
     long aprox;
 
+    // nearest point, halves rounded up
+    x = (point - universe->start_uod) * universe->scale;
+
+    // clamped before the conversion to long, which is undefined for NaN and huge values (NaN goes to the
+    // first point)
+    if (! (x > 0)) return 0;
+    if (x >= (double) (universe->npoints - 1)) return universe->npoints - 1;
+
+    aprox = (long) floor (x);
+    if (x - (double) aprox >= 0.5)
+        aprox = aprox + 1;
+
+    return aprox;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+double UniverseDiscPos (const struct SUniverse *universe, long disc)
+{
+    // point disc is at start_uod + disc * step, where MembershipKernel () samples the tables
+    if (disc < 0) return universe->start_uod;
+
+    return universe->start_uod + (double) disc * universe->step;
+}
+
+//------------------------------------------------------------------------------
+fuzzy_t *SigletonSet (double point, long npoints, double start_uod, double stop_uod)
+{
+    fuzzy_t *aux;
+
 
-    aux = (double *) malloc (sizeof (double) * npoints);
+    aux = (fuzzy_t *) malloc (sizeof (fuzzy_t) * npoints);
     if (! aux)
     {
         printf ("\nError on allocating memory: SingletonSet ()\n");
         return NULL;
     }
 
+    SingletonInto (aux, point, npoints, start_uod, stop_uod);
+
+    return aux;
+}
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+void SingletonInto (fuzzy_t *set, double point, long npoints, double start_uod, double stop_uod)
+{
+    long aprox;
+
+    // ConvPosDisc () clamps: a point out of the universe sets its nearest end
     aprox = ConvPosDisc (point, npoints, start_uod, stop_uod);
-	memset ((double *) aux, 0, npoints * sizeof (double));
+	memset ((fuzzy_t *) set, 0, npoints * sizeof (fuzzy_t));
 
-    aux[aprox] = 1.0;
+    set[aprox] = 1.0;
 
-    return aux;
+    return;
 }
 //------------------------------------------------------------------------------
 
@@ -340,32 +604,21 @@ double Maximum (double value1, double value2)
 //------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------
-double *Cut (double **set, long npoints, double alpha, int flag)
+fuzzy_t *Cut (fuzzy_t **set, long npoints, double alpha, int flag)
 {
-    double *aux = NULL;
+    fuzzy_t *aux = NULL;
     long j;
 
     if (! flag)
     {
-	    aux = (double *) malloc (sizeof (double) * npoints);
+	    aux = (fuzzy_t *) malloc (sizeof (fuzzy_t) * npoints);
 		if (aux == NULL)
 		{
 			printf ("\nError on allocating memory: Cut ()");
 			return NULL;
 		}
 
-        for (j = 0; j < npoints; j++)
-        {
-            if ((* set)[j] >= alpha)
-            {
-                aux[j] = alpha;
-            }
-
-            else
-            {
-                aux[j] = (* set)[j];
-            }
-        }
+        CutInto (* set, aux, npoints, alpha);
 
 		return aux;
     }
@@ -383,6 +636,25 @@ double *Cut (double **set, long npoints, double alpha, int flag)
 
 	return aux;
 }
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+void CutInto (const fuzzy_t *set, fuzzy_t *cut, long npoints, double alpha)
+{
+    long j;
 
+    for (j = 0; j < npoints; j++)
+    {
+        if (set[j] >= alpha)
+        {
+            cut[j] = alpha;
+        }
 
+        else
+        {
+            cut[j] = set[j];
+        }
+    }
 
+    return;
+}
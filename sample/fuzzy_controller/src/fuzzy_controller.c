@@ -1,6 +1,7 @@
 #include <stdio.h>
 
 #include "openfuzz.h"
+#include "openfuzz.hpp"
 
 // limit values for fuzzy memberships
 // temperature
@@ -43,15 +44,24 @@
 #define MID_MAX		100.0
 #define END_MAX		100.0
 
-// temperature set
-struct SSets *temperature;
-struct SSets *dutycycle_control;
-
 // discrete points
 #define DISCRETE_PTS 10000
 
-// discrete fuzzy response
-double *fuzzy_resp;
+// linguistic variables: universe of discourse and one triangular membership function per term
+typedef openfuzz::Variable<openfuzz::Triangle, openfuzz::Triangle, openfuzz::Triangle> Temperature;
+typedef openfuzz::Variable<openfuzz::Triangle, openfuzz::Triangle, openfuzz::Triangle> DutyCycle;
+
+// membership tables computed by the compiler (same values as InitializeSets () + Fuzzification ()),
+// stored in read only memory: nothing to initialize or free at run time
+static constexpr openfuzz::Tables<Temperature, DISCRETE_PTS> temperature_tables (Temperature (5.0, 45.0,
+										openfuzz::Triangle (START_COLD, MID_COLD, END_COLD),
+										openfuzz::Triangle (START_WARM, MID_WARM, END_WARM),
+										openfuzz::Triangle (START_HOT,  MID_HOT,  END_HOT)));
+
+static constexpr openfuzz::Tables<DutyCycle, DISCRETE_PTS> dutycycle_tables (DutyCycle (0.0, 100.0,
+										openfuzz::Triangle (START_MIN, MID_MIN, END_MIN),
+										openfuzz::Triangle (START_MED, MID_MED, END_MED),
+										openfuzz::Triangle (START_MAX, MID_MAX, END_MAX)));
 
 // Menu Function
 int Menu (void);
@@ -60,23 +70,17 @@ int main (int argc, char **argv)
 {
 	double temp_value = 0;
 	double output_value = 0;
-	
-	// initialize fuzzy sets   (set name, number of memberships, discrete points, min range value, max range value, initial values for the vector)
-    InitializeSets (&temperature,  3, DISCRETE_PTS, 5.0, 45.0, 0.0);
-    InitializeSets (&dutycycle_control,  3, DISCRETE_PTS, 0.0, 100.0, 0.0);
 
-	// allocates memory for the fuzzy discretization map
-	fuzzy_resp = (double *) malloc (sizeof (double) * DISCRETE_PTS);
-    for (int i = 0;  i < DISCRETE_PTS; i++) fuzzy_resp[i] = 0;
-
-	// membership functions fuzzyfication - using triangular function type (could be trapezoidal or gaussian)
-	Fuzzification (&temperature[TEMP_COLD],	TRIANGULAR, START_COLD, MID_COLD, END_COLD);
-	Fuzzification (&temperature[TEMP_WARM],	TRIANGULAR, START_WARM, MID_WARM, END_WARM);
-	Fuzzification (&temperature[TEMP_HOT],	TRIANGULAR, START_HOT,  MID_HOT,  END_HOT);
+	// fuzzy sets: read only, they can be shared by any number of threads
+	const struct SSets *temperature = temperature_tables.sets;
+	const struct SSets *dutycycle_control = dutycycle_tables.sets;
 
-	Fuzzification (&dutycycle_control[CONTROL_MIN], TRIANGULAR, START_MIN, MID_MIN, END_MIN);
-	Fuzzification (&dutycycle_control[CONTROL_MED], TRIANGULAR, START_MED, MID_MED, END_MED);
-	Fuzzification (&dutycycle_control[CONTROL_MAX], TRIANGULAR, START_MAX, MID_MAX, END_MAX);
+	// discrete fuzzy response (only the window written by the rules is cleared and defuzzified),
+	// a thread running the controller owns its own SInference
+	struct SInference *inference;
+	
+	// allocates memory for the fuzzy discretization map
+	if (! InitializeInference (&inference, DISCRETE_PTS)) return 1;
 
 	int menu_resp = 0;
 	while (menu_resp != 2)
@@ -87,20 +91,20 @@ int main (int argc, char **argv)
 		{
 			printf ("\nTemperature: ");
 			scanf ("%lf", &temp_value);
-			memset ((double *) fuzzy_resp, 0, DISCRETE_PTS * sizeof (double));
+			ClearInference (inference);
 
 			// simple test rules
 			// 1 - if temperature is cold, then we do the minimum control (we are not going to warm the water if the user doesnt want it)
-			FuzzyIfInput1 (temperature, TEMP_COLD, temp_value, dutycycle_control, CONTROL_MIN, MANDANI, &fuzzy_resp);
+			InferenceIfInput1 (inference, temperature, TEMP_COLD, temp_value, dutycycle_control, CONTROL_MIN, MANDANI);
 
 			// 2 - if temperature is warm, then we enable a medium control (warm it a bit =))
-			FuzzyIfInput1 (temperature, TEMP_WARM, temp_value, dutycycle_control, CONTROL_MED, MANDANI, &fuzzy_resp);
+			InferenceIfInput1 (inference, temperature, TEMP_WARM, temp_value, dutycycle_control, CONTROL_MED, MANDANI);
 
 			// 3 - if user wants a hot temperature, then we enable a max control
-			FuzzyIfInput1 (temperature, TEMP_HOT, temp_value, dutycycle_control, CONTROL_MAX, MANDANI, &fuzzy_resp);
+			InferenceIfInput1 (inference, temperature, TEMP_HOT, temp_value, dutycycle_control, CONTROL_MAX, MANDANI);
 
 			// defuzzy the output
-			output_value = DeFuzzy (fuzzy_resp, dutycycle_control, COA);
+			output_value = InferenceDeFuzzy (inference, dutycycle_control, COA);
 
 			printf ("\nControl value: %lf\n", output_value);
 		}
@@ -110,7 +114,7 @@ int main (int argc, char **argv)
 		}
 	}
 
-	free (fuzzy_resp);
+	FreeInference (inference);
 	return 0;
 }
 
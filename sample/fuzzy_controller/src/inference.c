@@ -0,0 +1,205 @@
+/**
+ * @file
+ * @author  Andre Silva <andreluizeng@yahoo.com.br>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2012, Andre Luiz Vieira da Silva
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this software
+ *    must display the following acknowledgement:
+ *    This product includes software developed by the <organization>.
+ * 4. Neither the name of the <organization> nor the
+ *    names of its contributors may be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Andre Silva ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Andre Silva BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @section DESCRIPTION
+ *
+ */
+
+#include "inference.h"
+#include "fisutils.h"
+#include "implications.h"
+#include "defuzzy.h"
+#include "kernels.h"
+
+//-------------------------------------------------------------------------------------------------
+static int ReserveInference (struct SInference *inference, long npoints)
+{
+    fuzzy_t *aux;
+
+    if (npoints <= inference->npoints) return TRUE;
+
+    aux = (fuzzy_t *) malloc (sizeof (fuzzy_t) * npoints);
+    if (aux == NULL)
+    {
+        printf ("\nError on allocating memory: ReserveInference ()\n");
+        return FALSE;
+    }
+
+    inference->allocations++;
+
+    // the rules already aggregated are kept
+    memset (aux, 0, sizeof (fuzzy_t) * npoints);
+    if (inference->npoints) memcpy (aux, inference->fuzzy_values, sizeof (fuzzy_t) * inference->npoints);
+
+    free (inference->fuzzy_values);
+
+    inference->fuzzy_values = aux;
+    inference->npoints = npoints;
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int InitializeInference (struct SInference **inference, long npoints)
+{
+    struct SInference *aux;
+
+    aux = (struct SInference *) malloc (sizeof (struct SInference));
+    if (aux == NULL) return FALSE;
+
+    memset (aux, 0, sizeof (struct SInference));
+    aux->allocations = 1;
+    aux->first = 0;
+    aux->last = -1;
+
+    if (! ReserveInference (aux, npoints))
+    {
+        free (aux);
+        return FALSE;
+    }
+
+    (* inference) = aux;
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void FreeInference (struct SInference *inference)
+{
+    if (inference == NULL) return;
+
+    free (inference->fuzzy_values);
+    free (inference);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void ClearInference (struct SInference *inference)
+{
+    if (inference->first <= inference->last)
+        memset (&inference->fuzzy_values[inference->first], 0, sizeof (fuzzy_t) * (inference->last - inference->first + 1));
+
+    inference->first = 0;
+    inference->last = -1;
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void InferenceImplication (struct SInference *inference, const struct SSets *output, double alpha, int method)
+{
+    long first;
+    long last;
+
+    if (! CheckImplication (method, "InferenceImplication")) return;
+    if (! ReserveInference (inference, output->npoints)) return;
+
+    // out of its support the membership is 0, so MANDANI and LARSEN leave those points unchanged
+    if (method == ZADEH)
+    {
+        first = 0;
+        last = output->npoints - 1;
+    }
+    else
+    {
+        if (! (alpha > 0)) return;
+
+        first = output->first;
+        last = output->last;
+    }
+
+    if (first > last) return;
+
+    ImplicationKernel (&inference->fuzzy_values[first], &output->value[first], last - first + 1, alpha, method);
+
+    if (inference->first > inference->last)
+    {
+        inference->first = first;
+        inference->last = last;
+    }
+    else
+    {
+        if (first < inference->first) inference->first = first;
+        if (last > inference->last) inference->last = last;
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void InferenceIfInput1 (struct SInference *inference, const struct SSets *input_set1, int membership1, double value1,
+                        const struct SSets *output_set, int membership3, int method)
+{
+    if (! CheckImplication (method, "InferenceIfInput1")) return;
+
+    InferenceImplication (inference, &output_set[membership3], MembershipDegree (&input_set1[membership1], value1), method);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void InferenceIfInput2 (struct SInference *inference, const struct SSets *input_set1, int membership1, double value1, int op,
+                        const struct SSets *input_set2, int membership2, double value2,
+                        const struct SSets *output_set, int membership3, int method)
+{
+    double minmax;
+
+    if (! CheckImplication (method, "InferenceIfInput2")) return;
+
+    value1 = MembershipDegree (&input_set1[membership1], value1);
+    value2 = MembershipDegree (&input_set2[membership2], value2);
+
+    if (op == AND) minmax = Minimum (value1, value2);
+    else minmax = Maximum (value1, value2);
+
+    InferenceImplication (inference, &output_set[membership3], minmax, method);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+double InferenceDeFuzzy (const struct SInference *inference, const struct SSets *output_set, int method)
+{
+    return DeFuzzyRange (inference->fuzzy_values, output_set, method, inference->first, inference->last);
+}
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,1446 @@
+/**
+ * @file
+ * @author  Andre Silva <andreluizeng@yahoo.com.br>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2012, Andre Luiz Vieira da Silva
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this software
+ *    must display the following acknowledgement:
+ *    This product includes software developed by the <organization>.
+ * 4. Neither the name of the <organization> nor the
+ *    names of its contributors may be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Andre Silva ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Andre Silva BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @section DESCRIPTION
+ *
+ */
+
+#include "rulebase.h"
+#include "fisutils.h"
+#include "implications.h"
+#include "defuzzy.h"
+#include "kernels.h"
+#include "inference.h"
+
+//-------------------------------------------------------------------------------------------------
+static int IsAnalytic (int defuzzy)
+{
+    return (defuzzy == COA_ANALYTIC) || (defuzzy == BOA_ANALYTIC);
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int NeedsAggregate (int defuzzy)
+{
+    // COA is fused with the aggregation and the analytic methods use the strengths only
+    return (defuzzy != COA) && (! IsAnalytic (defuzzy));
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int OutputTerms (const struct SRuleBase *rules, int output)
+{
+    // TSK outputs have consequent terms instead of fuzzy sets
+    if (rules->method == TSK) return rules->nterms[output];
+
+    return rules->outputs[output][0].nsets;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void FreeSupportIndex (struct SSupportIndex *index)
+{
+    free (index->breaks);
+    free (index->first);
+    free (index->terms);
+
+    index->breaks = NULL;
+    index->first = NULL;
+    index->terms = NULL;
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static unsigned int SetsRevision (const struct SSets *sets)
+{
+    int i;
+    unsigned int revision;
+
+    // the revisions only grow, so the sum changes whenever a set of the variable is fuzzified again
+    for (i = 0, revision = 0; i < sets[0].nsets; i++) revision = revision + sets[i].revision;
+
+    return revision;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void ReleaseCode (struct SRuleBase *rules)
+{
+    int i;
+
+    FreeRuleState (rules->state);
+
+    free (rules->code);
+    free (rules->operands);
+    free (rules->degree_offset);
+    free (rules->and_first);
+    free (rules->and_list);
+    free (rules->or_first);
+    free (rules->or_list);
+    free (rules->consequent_offset);
+
+    if (rules->support != NULL)
+    {
+        for (i = 0; i < rules->ninputs; i++) FreeSupportIndex (&rules->support[i]);
+        free (rules->support);
+    }
+
+    rules->state = NULL;
+    rules->code = NULL;
+    rules->operands = NULL;
+    rules->degree_offset = NULL;
+    rules->ndegrees = 0;
+    rules->support = NULL;
+    rules->and_first = NULL;
+    rules->and_list = NULL;
+    rules->or_first = NULL;
+    rules->or_list = NULL;
+    rules->consequent_offset = NULL;
+    rules->nconsequents = 0;
+    rules->nand = 0;
+    rules->compiled = FALSE;
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int AllocateRuleState (struct SRuleState **state, const struct SRuleBase *rules)
+{
+    int i;
+
+    struct SRuleState *aux;
+
+    aux = (struct SRuleState *) malloc (sizeof (struct SRuleState));
+    if (aux == NULL) return FALSE;
+
+    memset (aux, 0, sizeof (struct SRuleState));
+
+    aux->rules = rules;
+    aux->generation = rules->generation;
+    aux->noutputs = rules->noutputs;
+
+    aux->degrees = (double *) calloc (rules->ndegrees, sizeof (double));
+    aux->inference = (struct SInference **) calloc (rules->noutputs, sizeof (struct SInference *));
+    aux->strength_max = (double *) malloc (sizeof (double) * rules->nconsequents);
+    aux->strength_min = (double *) malloc (sizeof (double) * rules->nconsequents);
+    aux->strength_sum = (double *) malloc (sizeof (double) * rules->nconsequents);
+    aux->pair_memberships = (int *) malloc (sizeof (int) * 2 * rules->nconsequents);
+    aux->pair_alphas = (double *) malloc (sizeof (double) * 2 * rules->nconsequents);
+    aux->stamp = (unsigned int *) calloc (rules->nrules + 1, sizeof (unsigned int));
+    aux->active = (int *) malloc (sizeof (int) * rules->ndegrees);
+    aux->batch_degrees = (double *) malloc (sizeof (double) * BATCH_SAMPLES * rules->ndegrees);
+    aux->batch_alpha = (double *) malloc (sizeof (double) * BATCH_SAMPLES);
+    aux->batch_max = (double *) malloc (sizeof (double) * BATCH_SAMPLES * rules->nconsequents);
+    aux->batch_min = (double *) malloc (sizeof (double) * BATCH_SAMPLES * rules->nconsequents);
+    aux->batch_sum = (double *) malloc (sizeof (double) * BATCH_SAMPLES * rules->nconsequents);
+    aux->batch_inputs = (double *) malloc (sizeof (double) * rules->ninputs);
+
+    InitializeEnvelope (&aux->envelope);
+
+    if ((aux->degrees == NULL) || (aux->inference == NULL) || (aux->strength_max == NULL) || (aux->strength_min == NULL) ||
+        (aux->strength_sum == NULL) || (aux->pair_memberships == NULL) || (aux->pair_alphas == NULL) || (aux->stamp == NULL) ||
+        (aux->active == NULL) || (aux->envelope == NULL) || (aux->batch_degrees == NULL) || (aux->batch_alpha == NULL) ||
+        (aux->batch_max == NULL) || (aux->batch_min == NULL) || (aux->batch_sum == NULL) || (aux->batch_inputs == NULL))
+    {
+        FreeRuleState (aux);
+        return FALSE;
+    }
+
+    for (i = 0; i < rules->noutputs; i++)
+    {
+        // TSK outputs have no universe to aggregate on
+        if (rules->method == TSK) continue;
+
+        if (! InitializeInference (&aux->inference[i], rules->outputs[i][0].npoints))
+        {
+            FreeRuleState (aux);
+            return FALSE;
+        }
+    }
+
+    (* state) = aux;
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int InitializeRuleBase (struct SRuleBase **rules, int ninputs, int noutputs, int method)
+{
+    struct SRuleBase *aux;
+
+    if ((ninputs <= 0) || (noutputs <= 0))
+    {
+        printf ("\nError: invalid number of variables: InitializeRuleBase ()\n");
+        return FALSE;
+    }
+
+    if ((method != TSK) && (! CheckImplication (method, "InitializeRuleBase"))) return FALSE;
+
+    aux = (struct SRuleBase *) malloc (sizeof (struct SRuleBase));
+    if (aux == NULL)
+    {
+        printf ("\nError on allocating memory: InitializeRuleBase ()\n");
+        return FALSE;
+    }
+
+    memset (aux, 0, sizeof (struct SRuleBase));
+
+    aux->ninputs = ninputs;
+    aux->noutputs = noutputs;
+    aux->method = method;
+
+    aux->inputs = (const struct SSets **) calloc (ninputs, sizeof (struct SSets *));
+    aux->outputs = (const struct SSets **) calloc (noutputs, sizeof (struct SSets *));
+    aux->defuzzy = (int *) calloc (noutputs, sizeof (int));
+    aux->nterms = (int *) calloc (noutputs, sizeof (int));
+    aux->order = (int *) calloc (noutputs, sizeof (int));
+    aux->coefficients = (double **) calloc (noutputs, sizeof (double *));
+
+    if ((aux->inputs == NULL) || (aux->outputs == NULL) || (aux->defuzzy == NULL) ||
+        (aux->nterms == NULL) || (aux->order == NULL) || (aux->coefficients == NULL))
+    {
+        printf ("\nError on allocating memory: InitializeRuleBase ()\n");
+        FreeRuleBase (aux);
+        return FALSE;
+    }
+
+    (* rules) = aux;
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void FreeRuleBase (struct SRuleBase *rules)
+{
+    int i;
+
+    if (rules == NULL) return;
+
+    ReleaseCode (rules);
+
+    if (rules->coefficients != NULL)
+        for (i = 0; i < rules->noutputs; i++) free (rules->coefficients[i]);
+
+    free (rules->inputs);
+    free (rules->outputs);
+    free (rules->defuzzy);
+    free (rules->nterms);
+    free (rules->order);
+    free (rules->coefficients);
+    free (rules->rules);
+    free (rules->antecedents);
+    free (rules);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int SetRuleInput (struct SRuleBase *rules, int input, const struct SSets *sets)
+{
+    if ((input < 0) || (input >= rules->ninputs) || (sets == NULL))
+    {
+        printf ("\nError: invalid input variable %d: SetRuleInput ()\n", input);
+        return FALSE;
+    }
+
+    rules->inputs[input] = sets;
+    rules->compiled = FALSE;
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int SetRuleOutput (struct SRuleBase *rules, int output, const struct SSets *sets, int defuzzy)
+{
+    if ((output < 0) || (output >= rules->noutputs) || (sets == NULL))
+    {
+        printf ("\nError: invalid output variable %d: SetRuleOutput ()\n", output);
+        return FALSE;
+    }
+
+    if (rules->method == TSK)
+    {
+        printf ("\nError: TSK outputs are set with SetSugenoOutput (): SetRuleOutput ()\n");
+        return FALSE;
+    }
+
+    if ((sets[0].value == NULL) && (! IsAnalytic (defuzzy)))
+    {
+        printf ("\nError: output variable %d has no membership vectors: SetRuleOutput ()\n", output);
+        return FALSE;
+    }
+
+    rules->outputs[output] = sets;
+    rules->defuzzy[output] = defuzzy;
+    rules->compiled = FALSE;
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int SetSugenoOutput (struct SRuleBase *rules, int output, int nterms, int order, const double *coefficients)
+{
+    int k;
+    int i;
+    int ncoefficients;
+
+    double *aux;
+
+    if ((output < 0) || (output >= rules->noutputs) || (nterms <= 0) || (coefficients == NULL))
+    {
+        printf ("\nError: invalid output variable %d: SetSugenoOutput ()\n", output);
+        return FALSE;
+    }
+
+    if (rules->method != TSK)
+    {
+        printf ("\nError: rule base method is not TSK: SetSugenoOutput ()\n");
+        return FALSE;
+    }
+
+    if ((order != 0) && (order != 1))
+    {
+        printf ("\nError: invalid consequent order %d: SetSugenoOutput ()\n", order);
+        return FALSE;
+    }
+
+    ncoefficients = rules->ninputs + 1;
+
+    aux = (double *) calloc (nterms * ncoefficients, sizeof (double));
+    if (aux == NULL)
+    {
+        printf ("\nError on allocating memory: SetSugenoOutput ()\n");
+        return FALSE;
+    }
+
+    // both orders are stored as rows of ninputs + 1 coefficients, order 0 rows only have the constant
+    for (k = 0; k < nterms; k++)
+    {
+        if (order == 0) aux[k * ncoefficients] = coefficients[k];
+        else for (i = 0; i < ncoefficients; i++) aux[k * ncoefficients + i] = coefficients[k * ncoefficients + i];
+    }
+
+    free (rules->coefficients[output]);
+
+    rules->coefficients[output] = aux;
+    rules->nterms[output] = nterms;
+    rules->order[output] = order;
+    rules->compiled = FALSE;
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int AddRuleArray (struct SRuleBase *rules, int op, double weight, int output, int membership, int nantecedents,
+                    const int *inputs, const int *memberships)
+{
+    int i;
+    int capacity;
+
+    struct SRule *rule;
+    struct SAntecedent *antecedent;
+
+    if ((op != AND) && (op != OR))
+    {
+        printf ("\nError: invalid operator %d: AddRule ()\n", op);
+        return FALSE;
+    }
+
+    if ((output < 0) || (output >= rules->noutputs) || (nantecedents <= 0))
+    {
+        printf ("\nError: invalid rule: AddRule ()\n");
+        return FALSE;
+    }
+
+    for (i = 0; i < nantecedents; i++)
+    {
+        if ((inputs[i] < 0) || (inputs[i] >= rules->ninputs))
+        {
+            printf ("\nError: invalid input variable %d: AddRule ()\n", inputs[i]);
+            return FALSE;
+        }
+    }
+
+    if (rules->nrules == rules->rules_capacity)
+    {
+        capacity = rules->rules_capacity ? rules->rules_capacity * 2 : 16;
+
+        rule = (struct SRule *) realloc (rules->rules, sizeof (struct SRule) * capacity);
+        if (rule == NULL)
+        {
+            printf ("\nError on allocating memory: AddRule ()\n");
+            return FALSE;
+        }
+
+        rules->rules = rule;
+        rules->rules_capacity = capacity;
+    }
+
+    if (rules->nantecedents + nantecedents > rules->antecedents_capacity)
+    {
+        capacity = rules->antecedents_capacity ? rules->antecedents_capacity : 32;
+        while (capacity < rules->nantecedents + nantecedents) capacity *= 2;
+
+        antecedent = (struct SAntecedent *) realloc (rules->antecedents, sizeof (struct SAntecedent) * capacity);
+        if (antecedent == NULL)
+        {
+            printf ("\nError on allocating memory: AddRule ()\n");
+            return FALSE;
+        }
+
+        rules->antecedents = antecedent;
+        rules->antecedents_capacity = capacity;
+    }
+
+    rule = &rules->rules[rules->nrules];
+    rule->op = op;
+    rule->weight = weight;
+    rule->output = output;
+    rule->membership = membership;
+    rule->first = rules->nantecedents;
+    rule->nantecedents = nantecedents;
+
+    for (i = 0; i < nantecedents; i++)
+    {
+        antecedent = &rules->antecedents[rules->nantecedents + i];
+        antecedent->input = inputs[i];
+        antecedent->membership = memberships[i];
+    }
+
+    rules->nantecedents += nantecedents;
+    rules->nrules++;
+    rules->compiled = FALSE;
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int AddRule (struct SRuleBase *rules, int op, double weight, int output, int membership, int nantecedents, ...)
+{
+    va_list args;
+
+    int i;
+    int result;
+    int *inputs;
+    int *memberships;
+
+    if (nantecedents <= 0)
+    {
+        printf ("\nError: invalid rule: AddRule ()\n");
+        return FALSE;
+    }
+
+    inputs = (int *) malloc (sizeof (int) * nantecedents * 2);
+    if (inputs == NULL)
+    {
+        printf ("\nError on allocating memory: AddRule ()\n");
+        return FALSE;
+    }
+
+    memberships = inputs + nantecedents;
+
+    va_start (args, nantecedents);
+
+    for (i = 0; i < nantecedents; i++)
+    {
+        inputs[i] = va_arg (args, int);
+        memberships[i] = va_arg (args, int);
+    }
+
+    va_end (args);
+
+    result = AddRuleArray (rules, op, weight, output, membership, nantecedents, inputs, memberships);
+
+    free (inputs);
+
+    return result;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int CompileRules (struct SRuleBase *rules, int op, int ncode, int noperands)
+{
+    int i;
+    int j;
+
+    double width;
+    double narrowest;
+
+    const struct SSets *set;
+    struct SRule *rule;
+    struct SRuleCode *code;
+    struct SAntecedent *antecedent;
+
+    for (i = 0; i < rules->nrules; i++)
+    {
+        rule = &rules->rules[i];
+
+        // single antecedent rules are AND rules (no operator at all)
+        if ((rule->nantecedents == 1 ? AND : rule->op) != op) continue;
+
+        code = &rules->code[ncode++];
+        code->first = noperands;
+        code->count = rule->nantecedents;
+        code->output = rule->output;
+        code->membership = rule->membership;
+        code->weight = rule->weight;
+        code->consequent = rules->consequent_offset[rule->output] + rule->membership;
+
+        for (j = 0, narrowest = HUGE_VAL; j < rule->nantecedents; j++)
+        {
+            antecedent = &rules->antecedents[rule->first + j];
+            set = &rules->inputs[antecedent->input][antecedent->membership];
+
+            // support width relative to the universe, an empty set (negative width) is always picked
+            width = (set->support_stop - set->support_start) / (set->stop_uod - set->start_uod);
+
+            if ((j == 0) || (width < narrowest))
+            {
+                narrowest = width;
+                code->pivot = rules->degree_offset[antecedent->input] + antecedent->membership;
+            }
+
+            rules->operands[noperands++] = rules->degree_offset[antecedent->input] + antecedent->membership;
+        }
+    }
+
+    return noperands;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int CompareBreaks (const void *a, const void *b)
+{
+    double x = * (const double *) a;
+    double y = * (const double *) b;
+
+    return (x > y) - (x < y);
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int BuildSupportIndex (struct SSupportIndex *index, const struct SSets *sets)
+{
+    int i;
+    int k;
+    int n;
+    int nsets;
+
+    double lo;
+    double hi;
+
+    nsets = sets[0].nsets;
+    index->revision = SetsRevision (sets);
+
+    index->breaks = (double *) malloc (sizeof (double) * (2 * nsets + 1));
+    index->first = (int *) malloc (sizeof (int) * (2 * nsets + 2));
+    index->terms = (int *) malloc (sizeof (int) * (2 * nsets + 1) * nsets);
+
+    if ((index->breaks == NULL) || (index->first == NULL) || (index->terms == NULL)) return FALSE;
+
+    // finite bounds of the non empty sets, sorted and without repetitions
+    for (i = 0, n = 0; i < nsets; i++)
+    {
+        if (sets[i].support_start > sets[i].support_stop) continue;
+
+        if (sets[i].support_start > -HUGE_VAL) index->breaks[n++] = sets[i].support_start;
+        if (sets[i].support_stop < HUGE_VAL) index->breaks[n++] = sets[i].support_stop;
+    }
+
+    qsort (index->breaks, n, sizeof (double), CompareBreaks);
+
+    for (i = 0, k = 0; i < n; i++)
+        if ((k == 0) || (index->breaks[i] != index->breaks[k - 1])) index->breaks[k++] = index->breaks[i];
+
+    index->nbreaks = k;
+
+    // a set is listed in segment [lo, hi) when its support [support_start, support_stop] touches it
+    for (k = 0, n = 0; k <= index->nbreaks; k++)
+    {
+        lo = (k == 0) ? -HUGE_VAL : index->breaks[k - 1];
+        hi = (k == index->nbreaks) ? HUGE_VAL : index->breaks[k];
+
+        index->first[k] = n;
+
+        for (i = 0; i < nsets; i++)
+        {
+            if (sets[i].support_start > sets[i].support_stop) continue;
+
+            if ((sets[i].support_start < hi) && (sets[i].support_stop >= lo)) index->terms[n++] = i;
+        }
+    }
+
+    index->first[index->nbreaks + 1] = n;
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void GroupRules (int *first, int nslots)
+{
+    int k;
+
+    // first[k + 1] was advanced while filling the lists, shifting it back gives the start of each group
+    for (k = nslots; k > 0; k--) first[k] = first[k - 1];
+    first[0] = 0;
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int BuildRuleIndex (struct SRuleBase *rules)
+{
+    int i;
+    int j;
+    int k;
+
+    const struct SRuleCode *code;
+
+    rules->support = (struct SSupportIndex *) calloc (rules->ninputs, sizeof (struct SSupportIndex));
+    rules->and_first = (int *) calloc (rules->ndegrees + 1, sizeof (int));
+    rules->and_list = (int *) malloc (sizeof (int) * (rules->nand + 1));
+    rules->or_first = (int *) calloc (rules->ndegrees + 1, sizeof (int));
+    rules->or_list = (int *) malloc (sizeof (int) * (rules->nantecedents + 1));
+
+    if ((rules->support == NULL) || (rules->and_first == NULL) || (rules->and_list == NULL) || (rules->or_first == NULL) ||
+        (rules->or_list == NULL))
+        return FALSE;
+
+    for (i = 0; i < rules->ninputs; i++)
+        if (! BuildSupportIndex (&rules->support[i], rules->inputs[i])) return FALSE;
+
+    // AND rules are listed under their pivot only (they cannot fire if it does not), OR rules under every antecedent
+    for (i = 0; i < rules->nand; i++) rules->and_first[rules->code[i].pivot + 1]++;
+
+    for (i = rules->nand; i < rules->nrules; i++)
+    {
+        code = &rules->code[i];
+        for (j = code->first; j < code->first + code->count; j++) rules->or_first[rules->operands[j] + 1]++;
+    }
+
+    for (k = 0; k < rules->ndegrees; k++)
+    {
+        rules->and_first[k + 1] += rules->and_first[k];
+        rules->or_first[k + 1] += rules->or_first[k];
+    }
+
+    for (i = 0; i < rules->nand; i++) rules->and_list[rules->and_first[rules->code[i].pivot]++] = i;
+
+    for (i = rules->nand; i < rules->nrules; i++)
+    {
+        code = &rules->code[i];
+        for (j = code->first; j < code->first + code->count; j++) rules->or_list[rules->or_first[rules->operands[j]]++] = i;
+    }
+
+    GroupRules (rules->and_first, rules->ndegrees);
+    GroupRules (rules->or_first, rules->ndegrees);
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int CompileRuleBase (struct SRuleBase *rules)
+{
+    int i;
+    int j;
+    int noperands;
+
+    struct SRule *rule;
+    struct SAntecedent *antecedent;
+    const struct SSets *sets;
+
+    ReleaseCode (rules);
+
+    for (i = 0; i < rules->ninputs; i++)
+    {
+        if (rules->inputs[i] == NULL)
+        {
+            printf ("\nError: input variable %d not set: CompileRuleBase ()\n", i);
+            return FALSE;
+        }
+    }
+
+    for (i = 0; i < rules->noutputs; i++)
+    {
+        if ((rules->method == TSK) ? (rules->coefficients[i] == NULL) : (rules->outputs[i] == NULL))
+        {
+            printf ("\nError: output variable %d not set: CompileRuleBase ()\n", i);
+            return FALSE;
+        }
+    }
+
+    for (i = 0; i < rules->nantecedents; i++)
+    {
+        antecedent = &rules->antecedents[i];
+        sets = rules->inputs[antecedent->input];
+
+        if ((antecedent->membership < 0) || (antecedent->membership >= sets[0].nsets))
+        {
+            printf ("\nError: invalid membership %d of input variable %d: CompileRuleBase ()\n", antecedent->membership, antecedent->input);
+            return FALSE;
+        }
+    }
+
+    for (i = 0; i < rules->nrules; i++)
+    {
+        rule = &rules->rules[i];
+
+        if ((rule->membership < 0) || (rule->membership >= OutputTerms (rules, rule->output)))
+        {
+            printf ("\nError: invalid membership %d of output variable %d: CompileRuleBase ()\n", rule->membership, rule->output);
+            return FALSE;
+        }
+    }
+
+    for (i = 0; i < rules->noutputs; i++)
+    {
+        if ((rules->method == TSK) || (! IsAnalytic (rules->defuzzy[i]))) continue;
+
+        for (j = 0; j < rules->outputs[i][0].nsets; j++)
+        {
+            if ((rules->outputs[i][j].type != TRIANGULAR) && (rules->outputs[i][j].type != TRAPEZOIDAL))
+            {
+                printf ("\nError: membership %d of output variable %d is not TRIANGULAR or TRAPEZOIDAL: CompileRuleBase ()\n", j, i);
+                return FALSE;
+            }
+        }
+    }
+
+    for (i = 0, rules->ndegrees = 0; i < rules->ninputs; i++) rules->ndegrees += rules->inputs[i][0].nsets;
+    for (i = 0, rules->nconsequents = 0; i < rules->noutputs; i++) rules->nconsequents += OutputTerms (rules, i);
+
+    rules->code = (struct SRuleCode *) malloc (sizeof (struct SRuleCode) * (rules->nrules + 1));
+    rules->operands = (int *) malloc (sizeof (int) * (rules->nantecedents + 1));
+    rules->degree_offset = (int *) malloc (sizeof (int) * rules->ninputs);
+    rules->consequent_offset = (int *) malloc (sizeof (int) * rules->noutputs);
+
+    if ((rules->code == NULL) || (rules->operands == NULL) || (rules->degree_offset == NULL) || (rules->consequent_offset == NULL))
+    {
+        printf ("\nError on allocating memory: CompileRuleBase ()\n");
+        ReleaseCode (rules);
+        return FALSE;
+    }
+
+    for (i = 0, noperands = 0; i < rules->ninputs; i++)
+    {
+        rules->degree_offset[i] = noperands;
+        noperands += rules->inputs[i][0].nsets;
+    }
+
+    for (i = 0, noperands = 0; i < rules->noutputs; i++)
+    {
+        rules->consequent_offset[i] = noperands;
+        noperands += OutputTerms (rules, i);
+    }
+
+    for (i = 0, rules->nand = 0; i < rules->nrules; i++)
+        if ((rules->rules[i].nantecedents == 1) || (rules->rules[i].op == AND)) rules->nand++;
+
+    // AND rules first and OR rules after them, so Evaluate () runs one loop per operator
+    noperands = CompileRules (rules, AND, 0, 0);
+    CompileRules (rules, OR, rules->nand, noperands);
+
+    if (! BuildRuleIndex (rules))
+    {
+        printf ("\nError on allocating memory: CompileRuleBase ()\n");
+        ReleaseCode (rules);
+        return FALSE;
+    }
+
+    // a rule that does not fire adds nothing to the aggregation (or to the TSK average) only with MANDANI, LARSEN and TSK
+    rules->pruning = (rules->method == MANDANI) || (rules->method == LARSEN) || (rules->method == TSK);
+    rules->generation++;
+
+    // state used by Evaluate () and InferBatch (), other threads create their own with InitializeRuleState ()
+    if (! AllocateRuleState (&rules->state, rules))
+    {
+        printf ("\nError on allocating memory: CompileRuleBase ()\n");
+        ReleaseCode (rules);
+        return FALSE;
+    }
+
+    rules->compiled = TRUE;
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int InitializeRuleState (struct SRuleState **state, const struct SRuleBase *rules)
+{
+    if (! rules->compiled)
+    {
+        printf ("\nError: rule base not compiled: InitializeRuleState ()\n");
+        return FALSE;
+    }
+
+    if (! AllocateRuleState (state, rules))
+    {
+        printf ("\nError on allocating memory: InitializeRuleState ()\n");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void FreeRuleState (struct SRuleState *state)
+{
+    int i;
+
+    if (state == NULL) return;
+
+    if (state->inference != NULL)
+    {
+        for (i = 0; i < state->noutputs; i++) FreeInference (state->inference[i]);
+        free (state->inference);
+    }
+
+    FreeEnvelope (state->envelope);
+
+    free (state->degrees);
+    free (state->strength_max);
+    free (state->strength_min);
+    free (state->strength_sum);
+    free (state->pair_memberships);
+    free (state->pair_alphas);
+    free (state->stamp);
+    free (state->active);
+    free (state->batch_degrees);
+    free (state->batch_alpha);
+    free (state->batch_max);
+    free (state->batch_min);
+    free (state->batch_sum);
+    free (state->batch_inputs);
+    free (state);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void FuzzifyInputs (const struct SRuleBase *rules, struct SRuleState *state, const double *inputs)
+{
+    int i;
+    int j;
+
+    const fuzzy_t *vector;
+    const struct SSets *sets;
+    double *degrees;
+
+    for (i = 0; i < rules->ninputs; i++)
+    {
+        sets = rules->inputs[i];
+        degrees = &state->degrees[rules->degree_offset[i]];
+
+        vector = MembershipVector (sets, inputs[i]);
+
+        // the interleaved row may be stored in single precision (fuzzy_t), the degrees are always double
+        if (vector != NULL) for (j = 0; j < sets[0].nsets; j++) degrees[j] = vector[j];
+        else for (j = 0; j < sets[0].nsets; j++) degrees[j] = MembershipDegree (&sets[j], inputs[i]);
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void FireRule (const struct SRuleBase *rules, struct SRuleState *state, const struct SRuleCode *code, double alpha)
+{
+    // the rule is only reduced into the strength of its consequent, the output is clipped by ClipConsequents ()
+    alpha = alpha * code->weight;
+
+    if (rules->method == TSK)
+    {
+        state->strength_sum[code->consequent] += alpha;
+        return;
+    }
+
+    state->strength_max[code->consequent] = Maximum (state->strength_max[code->consequent], alpha);
+    state->strength_min[code->consequent] = Minimum (state->strength_min[code->consequent], alpha);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void ResetConsequents (const struct SRuleBase *rules, struct SRuleState *state)
+{
+    int i;
+
+    if (rules->method == TSK)
+    {
+        memset (state->strength_sum, 0, sizeof (double) * rules->nconsequents);
+        return;
+    }
+
+    // -HUGE_VAL marks a consequent with no rule fired (ZADEH adds 1 - alpha even for alpha = 0)
+    for (i = 0; i < rules->nconsequents; i++)
+    {
+        state->strength_max[i] = -HUGE_VAL;
+        state->strength_min[i] = HUGE_VAL;
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void ClipConsequents (const struct SRuleBase *rules, struct SRuleState *state)
+{
+    int i;
+    int j;
+    int c;
+
+    const struct SSets *output;
+
+    if (rules->method == TSK) return;
+
+    for (i = 0; i < rules->noutputs; i++)
+    {
+        if (! NeedsAggregate (rules->defuzzy[i])) continue;
+
+        for (j = 0; j < rules->outputs[i][0].nsets; j++)
+        {
+            c = rules->consequent_offset[i] + j;
+            if (state->strength_max[c] == -HUGE_VAL) continue;
+
+            output = &rules->outputs[i][j];
+
+            // only the support of the output membership is written, ClearInference () and InferenceDeFuzzy () use that window
+            InferenceImplication (state->inference[i], output, state->strength_max[c], rules->method);
+
+            if ((rules->method == ZADEH) && (state->strength_min[c] < state->strength_max[c]))
+                InferenceImplication (state->inference[i], output, state->strength_min[c], rules->method);
+        }
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int CollectPairs (const struct SRuleBase *rules, struct SRuleState *state, int output)
+{
+    int j;
+    int c;
+    int n;
+
+    // one (membership, strength) pair per fired consequent, two with ZADEH
+    for (j = 0, n = 0; j < rules->outputs[output][0].nsets; j++)
+    {
+        c = rules->consequent_offset[output] + j;
+        if (state->strength_max[c] == -HUGE_VAL) continue;
+
+        state->pair_memberships[n] = j;
+        state->pair_alphas[n++] = state->strength_max[c];
+
+        if ((rules->method == ZADEH) && (state->strength_min[c] < state->strength_max[c]))
+        {
+            state->pair_memberships[n] = j;
+            state->pair_alphas[n++] = state->strength_min[c];
+        }
+    }
+
+    return n;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static double DeFuzzyOutput (const struct SRuleBase *rules, struct SRuleState *state, int output)
+{
+    int n;
+
+    if (NeedsAggregate (rules->defuzzy[output]))
+        return InferenceDeFuzzy (state->inference[output], rules->outputs[output], rules->defuzzy[output]);
+
+    n = CollectPairs (rules, state, output);
+
+    if (rules->defuzzy[output] == COA)
+        return DeFuzzyAggregate (NULL, rules->outputs[output], state->pair_memberships, state->pair_alphas, n, rules->method);
+
+    return DeFuzzyEnvelope (state->envelope, rules->outputs[output], state->pair_memberships, state->pair_alphas, n,
+                            rules->method, rules->defuzzy[output]);
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static double SugenoOutput (const struct SRuleBase *rules, const struct SRuleState *state, int output, const double *inputs)
+{
+    int i;
+    int k;
+    int ncoefficients;
+
+    double term;
+    double weight;
+    double sum;
+    double weighted;
+
+    const double *row;
+    const double *strength;
+
+    strength = &state->strength_sum[rules->consequent_offset[output]];
+    ncoefficients = rules->ninputs + 1;
+
+    sum = 0;
+    weighted = 0;
+
+    // each term is evaluated once, with the summed strength of all its rules
+    for (k = 0; k < rules->nterms[output]; k++)
+    {
+        weight = strength[k];
+        if (! (weight > 0)) continue;
+
+        row = &rules->coefficients[output][k * ncoefficients];
+        term = row[0];
+
+        if (rules->order[output] == 1)
+            for (i = 0; i < rules->ninputs; i++) term = term + row[1 + i] * inputs[i];
+
+        sum = sum + weight;
+        weighted = weighted + weight * term;
+    }
+
+    // no rule fired
+    if (! (sum > 0)) return 0;
+
+    return weighted / sum;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int SupportSegment (const struct SSupportIndex *index, double point)
+{
+    int lo;
+    int hi;
+    int mid;
+
+    // number of breakpoints <= point
+    lo = 0;
+    hi = index->nbreaks;
+
+    while (lo < hi)
+    {
+        mid = (lo + hi) / 2;
+
+        if (index->breaks[mid] <= point) lo = mid + 1;
+        else hi = mid;
+    }
+
+    return lo;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void FuzzifyActive (const struct SRuleBase *rules, struct SRuleState *state, const double *inputs)
+{
+    int i;
+    int j;
+    int k;
+    int term;
+    int slot;
+
+    const fuzzy_t *vector;
+    const struct SSets *sets;
+    const struct SSupportIndex *index;
+
+    // the degrees of the previous inference are cleared, the others are already 0
+    for (i = 0; i < state->nactive; i++) state->degrees[state->active[i]] = 0;
+    state->nactive = 0;
+
+    for (i = 0; i < rules->ninputs; i++)
+    {
+        sets = rules->inputs[i];
+        index = &rules->support[i];
+
+        k = SupportSegment (index, inputs[i]);
+        vector = MembershipVector (sets, inputs[i]);
+
+        for (j = index->first[k]; j < index->first[k + 1]; j++)
+        {
+            term = index->terms[j];
+            slot = rules->degree_offset[i] + term;
+
+            state->degrees[slot] = (vector != NULL) ? vector[term] : MembershipDegree (&sets[term], inputs[i]);
+            state->active[state->nactive++] = slot;
+        }
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void EvaluateAll (const struct SRuleBase *rules, struct SRuleState *state, const double *inputs)
+{
+    int i;
+    int j;
+    int end;
+
+    double alpha;
+
+    const struct SRuleCode *code;
+    const double *degrees;
+    const int *operands;
+
+    FuzzifyInputs (rules, state, inputs);
+
+    degrees = state->degrees;
+    operands = rules->operands;
+
+    for (i = 0; i < rules->nand; i++)
+    {
+        code = &rules->code[i];
+        end = code->first + code->count;
+
+        alpha = 1;
+        for (j = code->first; j < end; j++) alpha = Minimum (alpha, degrees[operands[j]]);
+
+        FireRule (rules, state, code, alpha);
+    }
+
+    for (i = rules->nand; i < rules->nrules; i++)
+    {
+        code = &rules->code[i];
+        end = code->first + code->count;
+
+        alpha = 0;
+        for (j = code->first; j < end; j++) alpha = Maximum (alpha, degrees[operands[j]]);
+
+        FireRule (rules, state, code, alpha);
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void EvaluateActive (const struct SRuleBase *rules, struct SRuleState *state, const double *inputs)
+{
+    int i;
+    int j;
+    int k;
+    int r;
+    int end;
+    int slot;
+
+    double alpha;
+
+    const struct SRuleCode *code;
+    const double *degrees;
+    const int *operands;
+
+    FuzzifyActive (rules, state, inputs);
+
+    degrees = state->degrees;
+    operands = rules->operands;
+
+    // OR rules are listed once per antecedent, the stamp keeps them from firing twice
+    state->tick++;
+    if (state->tick == 0)
+    {
+        memset (state->stamp, 0, sizeof (unsigned int) * rules->nrules);
+        state->tick = 1;
+    }
+
+    for (i = 0; i < state->nactive; i++)
+    {
+        slot = state->active[i];
+
+        for (k = rules->and_first[slot]; k < rules->and_first[slot + 1]; k++)
+        {
+            code = &rules->code[rules->and_list[k]];
+            end = code->first + code->count;
+
+            alpha = 1;
+            for (j = code->first; j < end; j++) alpha = Minimum (alpha, degrees[operands[j]]);
+
+            FireRule (rules, state, code, alpha);
+        }
+
+        for (k = rules->or_first[slot]; k < rules->or_first[slot + 1]; k++)
+        {
+            r = rules->or_list[k];
+            if (state->stamp[r] == state->tick) continue;
+            state->stamp[r] = state->tick;
+
+            code = &rules->code[r];
+            end = code->first + code->count;
+
+            alpha = 0;
+            for (j = code->first; j < end; j++) alpha = Maximum (alpha, degrees[operands[j]]);
+
+            FireRule (rules, state, code, alpha);
+        }
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int CheckState (const struct SRuleBase *rules, const struct SRuleState *state, const char *function)
+{
+    if (! rules->compiled)
+    {
+        printf ("\nError: rule base not compiled: %s ()\n", function);
+        return FALSE;
+    }
+
+    // a state is sized for one compilation of one rule base
+    if ((state == NULL) || (state->rules != rules) || (state->generation != rules->generation))
+    {
+        printf ("\nError: state not created for this rule base: %s ()\n", function);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int SupportCurrent (const struct SRuleBase *rules)
+{
+    int i;
+
+    for (i = 0; i < rules->ninputs; i++)
+        if (rules->support[i].revision != SetsRevision (rules->inputs[i])) return FALSE;
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int RefreshSupport (struct SRuleBase *rules)
+{
+    int i;
+
+    // only the index of the inputs with a set fuzzified again after CompileRuleBase () is rebuilt
+    for (i = 0; i < rules->ninputs; i++)
+    {
+        if (rules->support[i].revision == SetsRevision (rules->inputs[i])) continue;
+
+        FreeSupportIndex (&rules->support[i]);
+
+        if (! BuildSupportIndex (&rules->support[i], rules->inputs[i]))
+        {
+            printf ("\nError on allocating memory: Evaluate ()\n");
+            ReleaseCode (rules);
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int Evaluate (struct SRuleBase *rules, const double *inputs, double *outputs)
+{
+    if (rules->compiled && rules->pruning && (! RefreshSupport (rules))) return FALSE;
+
+    return EvaluateState (rules, rules->state, inputs, outputs);
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int EvaluateState (const struct SRuleBase *rules, struct SRuleState *state, const double *inputs, double *outputs)
+{
+    int i;
+
+    if (! CheckState (rules, state, "EvaluateState")) return FALSE;
+
+    for (i = 0; i < rules->noutputs; i++)
+        if ((rules->method != TSK) && NeedsAggregate (rules->defuzzy[i])) ClearInference (state->inference[i]);
+
+    ResetConsequents (rules, state);
+
+    // the rule base is read only here: with a stale support index (a set fuzzified again after
+    // CompileRuleBase ()) every rule is evaluated, Evaluate () rebuilds the index before calling it
+    if (rules->pruning && SupportCurrent (rules)) EvaluateActive (rules, state, inputs);
+    else EvaluateAll (rules, state, inputs);
+
+    ClipConsequents (rules, state);
+
+    for (i = 0; i < rules->noutputs; i++)
+        outputs[i] = (rules->method == TSK) ? SugenoOutput (rules, state, i, inputs) : DeFuzzyOutput (rules, state, i);
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void BatchDegrees (const struct SRuleBase *rules, struct SRuleState *state, double * const *inputs, long base, long n)
+{
+    int i;
+    int j;
+
+    const struct SSets *sets;
+
+    // one set at a time over the samples, its table stays in cache for the whole chunk
+    for (i = 0; i < rules->ninputs; i++)
+    {
+        sets = rules->inputs[i];
+
+        for (j = 0; j < sets[0].nsets; j++)
+            DegreeKernel (&state->batch_degrees[(rules->degree_offset[i] + j) * BATCH_SAMPLES], &sets[j], &inputs[i][base], n);
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void BatchRules (const struct SRuleBase *rules, struct SRuleState *state, long n)
+{
+    int i;
+    int j;
+    int op;
+    long k;
+
+    double *alpha;
+    double *strength;
+
+    const struct SRuleCode *code;
+
+    alpha = state->batch_alpha;
+
+    for (k = 0; k < (long) rules->nconsequents * BATCH_SAMPLES; k++)
+    {
+        state->batch_max[k] = -HUGE_VAL;
+        state->batch_min[k] = HUGE_VAL;
+        state->batch_sum[k] = 0;
+    }
+
+    for (i = 0; i < rules->nrules; i++)
+    {
+        code = &rules->code[i];
+        op = (i < rules->nand) ? AND : OR;
+
+        // degrees are in [0, 1], so the first operand is the same as starting from 1 (AND) or 0 (OR)
+        memcpy (alpha, &state->batch_degrees[rules->operands[code->first] * BATCH_SAMPLES], sizeof (double) * n);
+
+        for (j = code->first + 1; j < code->first + code->count; j++)
+            OperatorKernel (alpha, &state->batch_degrees[rules->operands[j] * BATCH_SAMPLES], n, op);
+
+        if (code->weight != 1.0)
+            for (k = 0; k < n; k++) alpha[k] = alpha[k] * code->weight;
+
+        // same reduction as FireRule ()
+        if (rules->method == TSK)
+        {
+            strength = &state->batch_sum[code->consequent * BATCH_SAMPLES];
+            for (k = 0; k < n; k++) strength[k] = strength[k] + alpha[k];
+            continue;
+        }
+
+        OperatorKernel (&state->batch_max[code->consequent * BATCH_SAMPLES], alpha, n, OR);
+
+        if (rules->method == ZADEH) OperatorKernel (&state->batch_min[code->consequent * BATCH_SAMPLES], alpha, n, AND);
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int InferBatch (struct SRuleBase *rules, double * const *inputs, double * const *outputs, long nsamples)
+{
+    return InferBatchState (rules, rules->state, inputs, outputs, nsamples);
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int InferBatchState (const struct SRuleBase *rules, struct SRuleState *state, double * const *inputs, double * const *outputs, long nsamples)
+{
+    int i;
+    int c;
+    long base;
+    long n;
+    long k;
+
+    if (! CheckState (rules, state, "InferBatchState")) return FALSE;
+
+    for (base = 0; base < nsamples; base += BATCH_SAMPLES)
+    {
+        n = nsamples - base;
+        if (n > BATCH_SAMPLES) n = BATCH_SAMPLES;
+
+        BatchDegrees (rules, state, inputs, base, n);
+        BatchRules (rules, state, n);
+
+        // clipping and defuzzification of each sample from its consequent strengths
+        for (k = 0; k < n; k++)
+        {
+            for (c = 0; c < rules->nconsequents; c++)
+            {
+                state->strength_max[c] = state->batch_max[c * BATCH_SAMPLES + k];
+                state->strength_min[c] = state->batch_min[c * BATCH_SAMPLES + k];
+                state->strength_sum[c] = state->batch_sum[c * BATCH_SAMPLES + k];
+            }
+
+            if (rules->method == TSK)
+            {
+                for (i = 0; i < rules->ninputs; i++) state->batch_inputs[i] = inputs[i][base + k];
+                for (i = 0; i < rules->noutputs; i++) outputs[i][base + k] = SugenoOutput (rules, state, i, state->batch_inputs);
+                continue;
+            }
+
+            for (i = 0; i < rules->noutputs; i++)
+                if (NeedsAggregate (rules->defuzzy[i])) ClearInference (state->inference[i]);
+
+            ClipConsequents (rules, state);
+
+            for (i = 0; i < rules->noutputs; i++) outputs[i][base + k] = DeFuzzyOutput (rules, state, i);
+        }
+    }
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
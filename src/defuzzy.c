@@ -39,131 +39,520 @@
 
 #include "defuzzy.h"
 #include "fisutils.h"
+#include "implications.h"
+#include "kernels.h"
 
-double DeFuzzy (double *fuzzy_values, struct SSets *output_set, int method)
+//-------------------------------------------------------------------------------------------------
+static double ReducedPosition (const struct SUniverse *universe, double position)
 {
-    double sum1;
-    double sum2;
-    double value;
+    // ReductionKernel () uses the point index as position, as UniverseDiscPos ()
+    return universe->start_uod + position * universe->step;
+}
+//-------------------------------------------------------------------------------------------------
 
-    double current_max;
-    double first_max;
-    double last_max;
-    int first_max_pos;
-    int last_max_pos;
+//-------------------------------------------------------------------------------------------------
+double DeFuzzy (const fuzzy_t *fuzzy_values, const struct SSets *output_set, int method)
+{
+    return DeFuzzyRange (fuzzy_values, output_set, method, 0, output_set[0].npoints - 1);
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+double DeFuzzyRange (const fuzzy_t *fuzzy_values, const struct SSets *output_set, int method, long first, long last)
+{
+    double sum;
+    double half;
+    double value;
+    double offset;
 
     long int i;
-    long int nmax;
 
-    double pos;
-    
+    struct SUniverse *universe;
+    struct SReduction reduction;
+
+    universe = output_set[0].universe;
     value = 0;
-    
+
+    // the vector has no membership parameters, the analytic methods use the discrete ones
+    if (method == COA_ANALYTIC) method = COA;
+    if (method == BOA_ANALYTIC) method = BOA;
+
+    if (first < 0) first = 0;
+    if (last > output_set[0].npoints - 1) last = output_set[0].npoints - 1;
+    if (first > last) return 0;
+
+    // one pass gives the sums of COA and BOA and the maxima of MOM, FOM and LOM (positions relative to first)
+    ReductionKernel (&fuzzy_values[first], last - first + 1, &reduction);
+
+    // no rule fired: the aggregated output is empty
+    if ((! (reduction.max > 0)) || (! (reduction.sum > 0))) return 0;
+
+    offset = (double) first;
+
     switch (method)
     {
-        case COA:   value = 0;
-                    sum1 = 0;
-		     sum2 = 0;
-
-
-			for (i = 0; i < output_set[0].npoints; i++)
-	               {
-				pos = ConvDiscPos (i, output_set[0].npoints, output_set[0].start_uod, output_set[0].stop_uod);
-				sum1 = sum1 + (fuzzy_values[i] * pos);
-				sum2 = sum2 + fuzzy_values[i];
-                    	}
-
-			if (! sum2) value = 0;
-			else value = sum1 / sum2;
-
-                    	break;
-
-
-        case MOM:	value = 0;
-			sum1 = 0;
-			nmax = 0;
-
-			for (i = 0; i < output_set[0].npoints; i++)
-			{
-                       	value = Maximum (value, fuzzy_values[i]);
-
-                       	if (fuzzy_values[i] == value)
-	                       {
-        	                    sum1 = sum1 + ConvDiscPos (i, output_set[0].npoints, output_set[0].start_uod, output_set[0].stop_uod);
-        	                    nmax++;
-        	               }
-
-			}
-
-			if (! nmax) value = 0;
-			value = sum1 / nmax;
-
-        		break;
-
-	case LOM:	value = 0;
-			current_max = 0;
-			first_max = 0;
-			first_max_pos = 0;
-			last_max = 0;
-			last_max_pos = 0;
-
-			for (i = 0; i < output_set[0].npoints; i++)
-			{
-				current_max = Maximum (first_max, fuzzy_values[i]);
-		                if (current_max > first_max)
-			        {
-					if (current_max > last_max)
-					{
-						first_max = last_max;
-						first_max_pos = last_max_pos;
-						last_max = current_max;
-						last_max_pos = i;
-					}
-					else if (current_max < last_max)
-					{
-						first_max = current_max;
-						first_max_pos = i;
-					}
-			        }
-			}
-
-			value = ConvDiscPos  (last_max_pos, output_set[0].npoints, output_set[0].start_uod, output_set[0].stop_uod);
-
-                   	break;
-
-	case FOM:	value = 0;
-			current_max = 0;
-			first_max = 0;
-			first_max_pos = 0;
-			last_max = 0;
-			last_max_pos = 0;
-
-			for (i = 0; i < output_set[0].npoints; i++)
-			{
-				current_max = Maximum (first_max, fuzzy_values[i]);
-
-		                if (current_max > first_max)
-			        {
-					if (current_max > last_max)
-					{
-						first_max = last_max;
-						first_max_pos = last_max_pos;
-
-						last_max = current_max;
-						last_max_pos = i;
-					}
-					else if (current_max < last_max)
-					{
-						first_max = current_max;
-						first_max_pos = i;
-					}
-			        }
-                   	}
-
-			value = ConvDiscPos  (first_max_pos, output_set[0].npoints, output_set[0].start_uod, output_set[0].stop_uod);
-
-	               break;
+        case COA:   value = ReducedPosition (universe, offset + reduction.moment / reduction.sum);
+                    break;
+
+        // all the points with the biggest value, not only the ones seen after a running maximum
+        case MOM:   value = ReducedPosition (universe, offset + reduction.max_moment / (double) reduction.nmax);
+                    break;
+
+        case FOM:   value = UniverseDiscPos (universe, first + reduction.first_max);
+                    break;
+
+        case LOM:   value = UniverseDiscPos (universe, first + reduction.last_max);
+                    break;
+
+        // first point where the area on its left reaches half of the total area
+        case BOA:   half = reduction.sum / 2;
+                    sum = 0;
+
+                    for (i = first; i < last; i++)
+                    {
+                        sum = sum + fuzzy_values[i];
+                        if (sum >= half) break;
+                    }
+
+                    value = UniverseDiscPos (universe, i);
+                    break;
+    }
+
+    return value;
+}
+//-------------------------------------------------------------------------------------------------
+double DeFuzzyAggregate (fuzzy_t *fuzzy_values, const struct SSets *output_set, const int *memberships, const double *alphas, int n,
+                         int implication)
+{
+    double sum;
+    double moment;
+
+    if (! CheckImplication (implication, "DeFuzzyAggregate")) return 0;
+
+    AggregationKernel (fuzzy_values, output_set, memberships, alphas, n, implication, &sum, &moment);
+
+    if (! (sum > 0)) return 0;
+
+    // the moment is over the point index, point i is at start_uod + i * step
+    return output_set[0].universe->start_uod + (moment / sum) * output_set[0].universe->step;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int InitializeEnvelope (struct SEnvelope **envelope)
+{
+    struct SEnvelope *aux;
+
+    aux = (struct SEnvelope *) malloc (sizeof (struct SEnvelope));
+    if (aux == NULL)
+    {
+        printf ("\nError on allocating memory: InitializeEnvelope ()\n");
+        return FALSE;
+    }
+
+    memset (aux, 0, sizeof (struct SEnvelope));
+
+    (* envelope) = aux;
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void FreeEnvelope (struct SEnvelope *envelope)
+{
+    if (envelope == NULL) return;
+
+    free (envelope->x[0]);
+    free (envelope->y[0]);
+    free (envelope->x[1]);
+    free (envelope->y[1]);
+    free (envelope->runs);
+    free (envelope);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int ReserveEnvelope (struct SEnvelope *envelope, int buffer, long size, int runs)
+{
+    long capacity;
+    double *aux;
+    long *aux_runs;
+
+    if (size > envelope->capacity[buffer])
+    {
+        capacity = envelope->capacity[buffer] ? envelope->capacity[buffer] : 64;
+        while (capacity < size) capacity = capacity * 2;
+
+        aux = (double *) realloc (envelope->x[buffer], sizeof (double) * capacity);
+        if (aux == NULL) return FALSE;
+        envelope->x[buffer] = aux;
+
+        aux = (double *) realloc (envelope->y[buffer], sizeof (double) * capacity);
+        if (aux == NULL) return FALSE;
+        envelope->y[buffer] = aux;
+
+        envelope->capacity[buffer] = capacity;
+    }
+
+    if (runs > envelope->runs_capacity)
+    {
+        aux_runs = (long *) realloc (envelope->runs, sizeof (long) * runs);
+        if (aux_runs == NULL) return FALSE;
+
+        envelope->runs = aux_runs;
+        envelope->runs_capacity = runs;
+    }
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static long ShapeVertices (const struct SSets *set, double alpha, int implication, double *x, double *y)
+{
+    double a;
+    double b;
+    double c;
+    double d;
+    double h;
+
+    // a triangle is a trapezoid with b = c
+    switch (set->type)
+    {
+        case TRIANGULAR:    a = set->params[0];
+                            b = set->params[1];
+                            c = set->params[1];
+                            d = set->params[2];
+                            break;
+
+        case TRAPEZOIDAL:   a = set->params[0];
+                            b = set->params[1];
+                            c = set->params[2];
+                            d = set->params[3];
+                            break;
+
+        default:            return -1;
+    }
+
+    if (implication == LARSEN)
+    {
+        x[0] = a;   y[0] = 0;
+        x[1] = b;   y[1] = alpha;
+        x[2] = c;   y[2] = alpha;
+        x[3] = d;   y[3] = 0;
+
+        return 4;
+    }
+
+    // MANDANI and the min (alpha, B) part of ZADEH: the shape cut at height h
+    h = Minimum (alpha, 1);
+
+    x[0] = a;               y[0] = 0;
+    x[1] = a + h * (b - a); y[1] = h;
+    x[2] = d - h * (d - c); y[2] = h;
+    x[3] = d;               y[3] = 0;
+
+    return 4;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static double RightLimit (const double *x, const double *y, long n, long *cursor, double u)
+{
+    long k;
+
+    // the function is 0 out of its vertices
+    while ((*cursor < n) && (x[*cursor] <= u)) (*cursor)++;
+    if ((*cursor == 0) || (*cursor == n)) return 0;
+
+    k = *cursor - 1;
+
+    return y[k] + (y[k + 1] - y[k]) * (u - x[k]) / (x[k + 1] - x[k]);
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static double LeftLimit (const double *x, const double *y, long n, long *cursor, double v)
+{
+    long k;
+
+    while ((*cursor < n) && (x[*cursor] < v)) (*cursor)++;
+    if ((*cursor == 0) || (*cursor == n)) return 0;
+
+    k = *cursor - 1;
+
+    return y[k] + (y[k + 1] - y[k]) * (v - x[k]) / (x[k + 1] - x[k]);
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void PushVertex (double *x, double *y, long *n, double px, double py)
+{
+    if ((*n > 0) && (x[*n - 1] == px) && (y[*n - 1] == py)) return;
+
+    x[*n] = px;
+    y[*n] = py;
+    (*n)++;
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static long MergeEnvelopes (const double *xa, const double *ya, long na, const double *xb, const double *yb, long nb, double *x, double *y)
+{
+    long n;
+    long ia;
+    long ib;
+    long ra;
+    long la;
+    long rb;
+    long lb;
+
+    double u;
+    double v;
+    double a0;
+    double a1;
+    double b0;
+    double b1;
+    double t;
+
+    n = 0;
+    ia = ib = 0;
+    ra = la = rb = lb = 0;
+
+    if ((na == 0) && (nb == 0)) return 0;
+
+    if (na == 0) u = xb[0];
+    else if (nb == 0) u = xa[0];
+    else u = Minimum (xa[0], xb[0]);
+
+    // both functions are linear between two consecutive vertex positions (of either one): the maximum
+    // is one line or two lines crossing once
+    while (TRUE)
+    {
+        while ((ia < na) && (xa[ia] <= u)) ia++;
+        while ((ib < nb) && (xb[ib] <= u)) ib++;
+
+        if ((ia == na) && (ib == nb)) break;
+
+        if (ia == na) v = xb[ib];
+        else if (ib == nb) v = xa[ia];
+        else v = Minimum (xa[ia], xb[ib]);
+
+        a0 = RightLimit (xa, ya, na, &ra, u);
+        b0 = RightLimit (xb, yb, nb, &rb, u);
+        a1 = LeftLimit (xa, ya, na, &la, v);
+        b1 = LeftLimit (xb, yb, nb, &lb, v);
+
+        PushVertex (x, y, &n, u, Maximum (a0, b0));
+
+        if ((a0 - b0) * (a1 - b1) < 0)
+        {
+            t = (a0 - b0) / ((a0 - b0) - (a1 - b1));
+            PushVertex (x, y, &n, u + t * (v - u), a0 + t * (a1 - a0));
+        }
+
+        PushVertex (x, y, &n, v, Maximum (a1, b1));
+
+        u = v;
+    }
+
+    return n;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int ClipSegment (double *x0, double *y0, double *x1, double *y1, double start, double stop)
+{
+    double slope;
+
+    if ((*x1 <= *x0) || (*x1 <= start) || (*x0 >= stop)) return FALSE;
+
+    slope = (*y1 - *y0) / (*x1 - *x0);
+
+    if (*x0 < start)
+    {
+        *y0 = *y0 + slope * (start - *x0);
+        *x0 = start;
+    }
+
+    if (*x1 > stop)
+    {
+        *y1 = *y1 - slope * (*x1 - stop);
+        *x1 = stop;
+    }
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static double IntegrateEnvelope (const double *x, const double *y, long n, double start, double stop, int method)
+{
+    long i;
+
+    double x0;
+    double x1;
+    double y0;
+    double y1;
+    double area;
+    double moment;
+    double segment;
+    double slope;
+    double rest;
+
+    area = 0;
+    moment = 0;
+
+    // exact integrals of a line: area and first moment of the trapezoid under it
+    for (i = 0; i + 1 < n; i++)
+    {
+        x0 = x[i]; y0 = y[i];
+        x1 = x[i + 1]; y1 = y[i + 1];
+
+        if (! ClipSegment (&x0, &y0, &x1, &y1, start, stop)) continue;
+
+        area = area + (x1 - x0) * (y0 + y1) / 2;
+        moment = moment + (x1 - x0) * (x0 * (2 * y0 + y1) + x1 * (y0 + 2 * y1)) / 6;
     }
 
+    if (area <= 0) return 0;
+
+    if (method != BOA_ANALYTIC) return moment / area;
+
+    // bisector: solve y0 t + slope t^2 / 2 = rest inside the segment that reaches half of the area
+    rest = area / 2;
+
+    for (i = 0; i + 1 < n; i++)
+    {
+        x0 = x[i]; y0 = y[i];
+        x1 = x[i + 1]; y1 = y[i + 1];
+
+        if (! ClipSegment (&x0, &y0, &x1, &y1, start, stop)) continue;
+
+        segment = (x1 - x0) * (y0 + y1) / 2;
+
+        if (segment >= rest)
+        {
+            if (rest <= 0) return x0;
+
+            slope = (y1 - y0) / (x1 - x0);
+
+            return x0 + 2 * rest / (y0 + sqrt (Maximum (0, y0 * y0 + 2 * slope * rest)));
+        }
+
+        rest = rest - segment;
+    }
+
+    return stop;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static double EnvelopeValue (struct SEnvelope *envelope, const struct SSets *output_set, const int *memberships, const double *alphas, int n,
+                             int implication, int method)
+{
+    int i;
+    int j;
+    int nruns;
+    int src;
+    long m;
+    long a;
+    long b;
+    long c;
+    long size;
+
+    // each pair gives one shape, ZADEH adds the constant 1 - alpha too
+    if (! ReserveEnvelope (envelope, 0, 6 * (long) n + 1, 2 * n + 1))
+    {
+        printf ("\nError on allocating memory: DeFuzzyEnvelope ()\n");
+        return 0;
+    }
+
+    nruns = 0;
+    size = 0;
+    envelope->runs[0] = 0;
+
+    for (i = 0; i < n; i++)
+    {
+        if (implication == ZADEH)
+        {
+            envelope->x[0][size] = output_set[0].start_uod;  envelope->y[0][size++] = 1 - alphas[i];
+            envelope->x[0][size] = output_set[0].stop_uod;   envelope->y[0][size++] = 1 - alphas[i];
+            envelope->runs[++nruns] = size;
+        }
+
+        if (alphas[i] <= 0) continue;
+
+        m = ShapeVertices (&output_set[memberships[i]], alphas[i], implication, &envelope->x[0][size], &envelope->y[0][size]);
+        if (m < 0)
+        {
+            printf ("\nError: membership %d is not TRIANGULAR or TRAPEZOIDAL: DeFuzzyEnvelope ()\n", memberships[i]);
+            return 0;
+        }
+
+        size = size + m;
+        envelope->runs[++nruns] = size;
+    }
+
+    // envelopes merged two by two, ping-ponging between the two buffers
+    src = 0;
+
+    while (nruns > 1)
+    {
+        if (! ReserveEnvelope (envelope, 1 - src, 3 * size + 1, 0))
+        {
+            printf ("\nError on allocating memory: DeFuzzyEnvelope ()\n");
+            return 0;
+        }
+
+        size = 0;
+
+        for (i = 0, j = 0; i < nruns; i = i + 2, j++)
+        {
+            a = envelope->runs[i];
+            b = envelope->runs[i + 1];
+            c = (i + 1 < nruns) ? envelope->runs[i + 2] : b;
+
+            envelope->runs[j] = size;
+            size = size + MergeEnvelopes (&envelope->x[src][a], &envelope->y[src][a], b - a, &envelope->x[src][b], &envelope->y[src][b], c - b,
+                                          &envelope->x[1 - src][size], &envelope->y[1 - src][size]);
+        }
+
+        envelope->runs[j] = size;
+        nruns = j;
+        src = 1 - src;
+    }
+
+    if (nruns == 0) return 0;
+
+    return IntegrateEnvelope (envelope->x[src], envelope->y[src], size, output_set[0].start_uod, output_set[0].stop_uod, method);
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+double DeFuzzyEnvelope (struct SEnvelope *envelope, const struct SSets *output_set, const int *memberships, const double *alphas, int n,
+                        int implication, int method)
+{
+    double value;
+
+    struct SEnvelope *aux;
+
+    if (! CheckImplication (implication, "DeFuzzyEnvelope")) return 0;
+
+    if (envelope != NULL) return EnvelopeValue (envelope, output_set, memberships, alphas, n, implication, method);
+
+    // temporary workspace
+    if (! InitializeEnvelope (&aux)) return 0;
+
+    value = EnvelopeValue (aux, output_set, memberships, alphas, n, implication, method);
+
+    FreeEnvelope (aux);
+
     return value;
 }
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,412 @@
+/**
+ * @file
+ * @author  Andre Silva <andreluizeng@yahoo.com.br>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2012, Andre Luiz Vieira da Silva
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this software
+ *    must display the following acknowledgement:
+ *    This product includes software developed by the <organization>.
+ * 4. Neither the name of the <organization> nor the
+ *    names of its contributors may be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Andre Silva ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Andre Silva BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @section DESCRIPTION
+ *
+ */
+
+// pthread_setaffinity_np () and CPU_SET ()
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "executor.h"
+#include "rulebase.h"
+
+#include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+//-------------------------------------------------------------------------------------------------
+static double Seconds (void)
+{
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+
+    return (double) now.tv_sec + (double) now.tv_nsec * 1e-9;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void PinWorker (struct SWorker *worker)
+{
+#ifdef __linux__
+    cpu_set_t set;
+
+    if (worker->cpu < 0) return;
+
+    CPU_ZERO (&set);
+    CPU_SET (worker->cpu, &set);
+
+    if (pthread_setaffinity_np (pthread_self (), sizeof (cpu_set_t), &set) != 0)
+        printf ("\nError: worker %d not pinned to cpu %d: InitializeExecutor ()\n", worker->id, worker->cpu);
+#endif
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static long TakeChunk (struct SWorker *worker)
+{
+    long chunk;
+
+    chunk = -1;
+
+    pthread_mutex_lock (&worker->lock);
+
+    if (worker->next < worker->end) chunk = worker->next++;
+
+    pthread_mutex_unlock (&worker->lock);
+
+    return chunk;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int StealChunks (struct SWorker *worker)
+{
+    int k;
+    long n;
+    long end;
+
+    struct SExecutor *executor;
+    struct SWorker *victim;
+
+    executor = worker->executor;
+
+    // the back half of the first range that is not empty, the victims are visited starting from the next worker
+    for (k = 1; k < executor->nthreads; k++)
+    {
+        victim = &executor->workers[(worker->id + k) % executor->nthreads];
+
+        pthread_mutex_lock (&victim->lock);
+
+        n = (victim->end - victim->next + 1) / 2;
+        end = victim->end;
+        victim->end -= n;
+
+        pthread_mutex_unlock (&victim->lock);
+
+        if (n == 0) continue;
+
+        pthread_mutex_lock (&worker->lock);
+
+        worker->next = end - n;
+        worker->end = end;
+
+        pthread_mutex_unlock (&worker->lock);
+
+        worker->counters.steals++;
+        worker->counters.stolen += n;
+
+        return TRUE;
+    }
+
+    return FALSE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void RunChunk (struct SWorker *worker, long chunk)
+{
+    int i;
+    long first;
+    long n;
+
+    double start;
+
+    struct SExecutor *executor;
+    const struct SRuleBase *rules;
+
+    executor = worker->executor;
+    rules = executor->rules;
+
+    first = chunk * EXECUTOR_CHUNK;
+    n = executor->nsamples - first;
+    if (n > EXECUTOR_CHUNK) n = EXECUTOR_CHUNK;
+
+    for (i = 0; i < rules->ninputs; i++) worker->columns[i] = executor->inputs[i] + first;
+    for (i = 0; i < rules->noutputs; i++) worker->columns[rules->ninputs + i] = executor->outputs[i] + first;
+
+    start = Seconds ();
+
+    InferBatchState (rules, worker->state, worker->columns, worker->columns + rules->ninputs, n);
+
+    worker->counters.busy += Seconds () - start;
+    worker->counters.samples += n;
+    worker->counters.chunks++;
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void *WorkerMain (void *arg)
+{
+    long chunk;
+    unsigned long job;
+
+    struct SWorker *worker;
+    struct SExecutor *executor;
+
+    worker = (struct SWorker *) arg;
+    executor = worker->executor;
+    job = 0;
+
+    PinWorker (worker);
+
+    while (TRUE)
+    {
+        pthread_mutex_lock (&executor->lock);
+
+        while ((executor->job == job) && (! executor->quit)) pthread_cond_wait (&executor->start, &executor->lock);
+
+        if (executor->quit)
+        {
+            pthread_mutex_unlock (&executor->lock);
+            break;
+        }
+
+        job = executor->job;
+
+        pthread_mutex_unlock (&executor->lock);
+
+        // own chunks first, then chunks stolen from the others until every range is empty
+        do
+        {
+            while ((chunk = TakeChunk (worker)) >= 0) RunChunk (worker, chunk);
+        }
+        while (StealChunks (worker));
+
+        pthread_mutex_lock (&executor->lock);
+
+        executor->running--;
+        if (executor->running == 0) pthread_cond_signal (&executor->done);
+
+        pthread_mutex_unlock (&executor->lock);
+    }
+
+    return NULL;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int InitializeExecutor (struct SExecutor **executor, const struct SRuleBase *rules, int nthreads, int pin)
+{
+    int i;
+    long ncpus;
+
+    struct SExecutor *aux;
+    struct SWorker *worker;
+
+    if (! rules->compiled)
+    {
+        printf ("\nError: rule base not compiled: InitializeExecutor ()\n");
+        return FALSE;
+    }
+
+    ncpus = sysconf (_SC_NPROCESSORS_ONLN);
+    if (ncpus < 1) ncpus = 1;
+
+    if (nthreads <= 0) nthreads = (int) ncpus;
+
+    aux = (struct SExecutor *) malloc (sizeof (struct SExecutor));
+    if (aux == NULL)
+    {
+        printf ("\nError on allocating memory: InitializeExecutor ()\n");
+        return FALSE;
+    }
+
+    memset (aux, 0, sizeof (struct SExecutor));
+
+    aux->rules = rules;
+    aux->workers = (struct SWorker *) calloc (nthreads, sizeof (struct SWorker));
+    if (aux->workers == NULL)
+    {
+        printf ("\nError on allocating memory: InitializeExecutor ()\n");
+        free (aux);
+        return FALSE;
+    }
+
+    pthread_mutex_init (&aux->lock, NULL);
+    pthread_cond_init (&aux->start, NULL);
+    pthread_cond_init (&aux->done, NULL);
+
+    // nthreads counts the workers started so far, FreeExecutor () only joins those
+    for (i = 0; i < nthreads; i++)
+    {
+        worker = &aux->workers[i];
+        worker->executor = aux;
+        worker->id = i;
+        worker->cpu = pin ? (int) (i % ncpus) : -1;
+
+        worker->columns = (double **) malloc (sizeof (double *) * (rules->ninputs + rules->noutputs));
+
+        if ((worker->columns == NULL) || (! InitializeRuleState (&worker->state, rules)))
+        {
+            printf ("\nError on allocating memory: InitializeExecutor ()\n");
+            free (worker->columns);
+            FreeExecutor (aux);
+            return FALSE;
+        }
+
+        pthread_mutex_init (&worker->lock, NULL);
+
+        if (pthread_create (&worker->thread, NULL, WorkerMain, worker) != 0)
+        {
+            printf ("\nError on creating worker thread %d: InitializeExecutor ()\n", i);
+            pthread_mutex_destroy (&worker->lock);
+            FreeRuleState (worker->state);
+            free (worker->columns);
+            FreeExecutor (aux);
+            return FALSE;
+        }
+
+        aux->nthreads++;
+    }
+
+    (* executor) = aux;
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void FreeExecutor (struct SExecutor *executor)
+{
+    int i;
+
+    if (executor == NULL) return;
+
+    pthread_mutex_lock (&executor->lock);
+    executor->quit = TRUE;
+    pthread_cond_broadcast (&executor->start);
+    pthread_mutex_unlock (&executor->lock);
+
+    for (i = 0; i < executor->nthreads; i++)
+    {
+        pthread_join (executor->workers[i].thread, NULL);
+        pthread_mutex_destroy (&executor->workers[i].lock);
+        FreeRuleState (executor->workers[i].state);
+        free (executor->workers[i].columns);
+    }
+
+    pthread_mutex_destroy (&executor->lock);
+    pthread_cond_destroy (&executor->start);
+    pthread_cond_destroy (&executor->done);
+
+    free (executor->workers);
+    free (executor);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int ExecuteBatch (struct SExecutor *executor, double * const *inputs, double * const *outputs, long nsamples)
+{
+    int i;
+    long nchunks;
+
+    if (nsamples <= 0) return TRUE;
+
+    if ((! executor->rules->compiled) || (executor->workers[0].state->generation != executor->rules->generation))
+    {
+        printf ("\nError: rule base compiled again after InitializeExecutor (): ExecuteBatch ()\n");
+        return FALSE;
+    }
+
+    nchunks = (nsamples + EXECUTOR_CHUNK - 1) / EXECUTOR_CHUNK;
+
+    pthread_mutex_lock (&executor->lock);
+
+    executor->inputs = inputs;
+    executor->outputs = outputs;
+    executor->nsamples = nsamples;
+
+    // contiguous ranges, the workers are waiting so the ranges can be written without their locks
+    for (i = 0; i < executor->nthreads; i++)
+    {
+        executor->workers[i].next = nchunks * i / executor->nthreads;
+        executor->workers[i].end = nchunks * (i + 1) / executor->nthreads;
+    }
+
+    executor->running = executor->nthreads;
+    executor->job++;
+
+    pthread_cond_broadcast (&executor->start);
+
+    while (executor->running > 0) pthread_cond_wait (&executor->done, &executor->lock);
+
+    pthread_mutex_unlock (&executor->lock);
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void ReportExecutor (const struct SExecutor *executor)
+{
+    int i;
+
+    const struct SWorkerCounters *counters;
+
+    printf ("\nthread  cpu    samples   chunks   steals   stolen   busy (s)\n");
+
+    for (i = 0; i < executor->nthreads; i++)
+    {
+        counters = &executor->workers[i].counters;
+
+        printf ("%6d %4d %10ld %8ld %8ld %8ld %10.4f\n", i, executor->workers[i].cpu, counters->samples, counters->chunks,
+                counters->steals, counters->stolen, counters->busy);
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void ResetExecutorCounters (struct SExecutor *executor)
+{
+    int i;
+
+    for (i = 0; i < executor->nthreads; i++) memset (&executor->workers[i].counters, 0, sizeof (struct SWorkerCounters));
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,618 @@
+/**
+ * @file
+ * @author  Andre Silva <andreluizeng@yahoo.com.br>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2012, Andre Luiz Vieira da Silva
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this software
+ *    must display the following acknowledgement:
+ *    This product includes software developed by the <organization>.
+ * 4. Neither the name of the <organization> nor the
+ *    names of its contributors may be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Andre Silva ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Andre Silva BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @section DESCRIPTION
+ *
+ */
+
+#include "fixed.h"
+#include "fisutils.h"
+#include "implications.h"
+#include "defuzzy.h"
+
+// points accumulated in 32 bits before being folded into the 64 bit sums (256 * 32768 * 255 < 2^32)
+#define FIXED_BLOCK     256
+
+//-------------------------------------------------------------------------------------------------
+static int ScaleFromRatio (struct SFixedScale *scale, uint64_t numerator, uint64_t denominator)
+{
+    uint64_t quotient;
+    uint64_t remainder;
+
+    if ((numerator == 0) || (denominator == 0) || (denominator >= ((uint64_t) 1 << 62))) return FALSE;
+
+    quotient = numerator / denominator;
+    remainder = numerator % denominator;
+    scale->shift = 0;
+
+    if (quotient >= ((uint64_t) 1 << 32)) return FALSE;
+
+    // integer arithmetic only: one more bit of numerator / denominator per shift, until mult is between
+    // 2^31 and 2^32 (the best precision for 32 bits)
+    while ((quotient < ((uint64_t) 1 << 31)) && (scale->shift < 62))
+    {
+        remainder = remainder << 1;
+        quotient = quotient << 1;
+        scale->shift++;
+
+        if (remainder >= denominator)
+        {
+            remainder -= denominator;
+            quotient++;
+        }
+    }
+
+    // rounded to nearest, 2^32 is 2^31 with one bit less
+    if (remainder >= denominator - remainder) quotient++;
+
+    if (quotient == ((uint64_t) 1 << 32))
+    {
+        if (scale->shift == 0) return FALSE;
+
+        quotient = quotient >> 1;
+        scale->shift--;
+    }
+
+    scale->mult = (uint32_t) quotient;
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static uint64_t ScaleValue (const struct SFixedScale *scale, uint32_t x)
+{
+    // x < 2^31 and mult < 2^32: the product fits in 63 bits
+    return ((uint64_t) x * scale->mult) >> scale->shift;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static uint16_t DegreeToQ15 (double degree)
+{
+    if (! (degree > 0)) return 0;
+    if (degree >= 1.0) return Q15_ONE;
+
+    return (uint16_t) floor (degree * Q15_ONE + 0.5);
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int FixedUniverse (struct SFixedScale *scale, struct SFixedScale *step, long npoints, int32_t start_uod, int32_t stop_uod,
+                          const char *caller)
+{
+    int64_t range = (int64_t) stop_uod - start_uod;
+
+    if ((npoints < 2) || (npoints > FIXED_MAX_POINTS))
+    {
+        printf ("\nError: a fixed point variable has 2 to %d points: %s ()\n", FIXED_MAX_POINTS, caller);
+        return FALSE;
+    }
+
+    // the universe range has to fit in 31 bits of Q16.16; scale is npoints / range and step range / npoints
+    if ((start_uod < -32767 * Q16_ONE) || (stop_uod > 32767 * Q16_ONE) || (range <= 0) || (range >= 32767 * Q16_ONE) ||
+        (! ScaleFromRatio (scale, (uint64_t) npoints * Q16_ONE, (uint64_t) range)) ||
+        (! ScaleFromRatio (step, (uint64_t) range, (uint64_t) npoints * Q16_ONE)))
+    {
+        printf ("\nError: universe of discourse out of the Q16.16 range: %s ()\n", caller);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void FixedSupport (struct SFixedSets *set)
+{
+    long j;
+
+    set->first = set->npoints;
+    set->last = -1;
+
+    for (j = 0; j < set->npoints; j++)
+    {
+        if (set->value[j] == 0) continue;
+        if (j < set->first) set->first = j;
+        set->last = j;
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int InitializeFixedSets (struct SFixedSets **fixed, const struct SSets *sets)
+{
+    int i;
+    long j;
+    long npoints;
+    int32_t start_uod;
+    int32_t stop_uod;
+    void *raw;
+    uint16_t *tables;
+    double degree;
+
+    struct SFixedSets *aux;
+    struct SFixedScale scale;
+    struct SFixedScale step;
+
+    if ((sets[0].mode == MEMBERSHIP_ANALYTIC) || (sets[0].universe == NULL))
+    {
+        printf ("\nError: the fixed point sets need a discretized variable: InitializeFixedSets ()\n");
+        return FALSE;
+    }
+
+    npoints = sets[0].npoints;
+
+    // checked before the conversion, DOUBLE_TO_Q16 () overflows out of the Q16.16 range
+    if ((sets[0].start_uod < -32767.0) || (sets[0].stop_uod > 32767.0))
+    {
+        printf ("\nError: universe of discourse out of the Q16.16 range: InitializeFixedSets ()\n");
+        return FALSE;
+    }
+
+    start_uod = DOUBLE_TO_Q16 (sets[0].start_uod);
+    stop_uod = DOUBLE_TO_Q16 (sets[0].stop_uod);
+
+    if (! FixedUniverse (&scale, &step, npoints, start_uod, stop_uod, "InitializeFixedSets")) return FALSE;
+
+    raw = malloc (sizeof (struct SFixedSets) * sets[0].nsets + sizeof (uint16_t) * npoints * sets[0].nsets);
+    if (raw == NULL)
+    {
+        printf ("\nError on allocating memory: InitializeFixedSets ()\n");
+        return FALSE;
+    }
+
+    aux = (struct SFixedSets *) raw;
+    tables = (uint16_t *) &aux[sets[0].nsets];
+
+    for (i = 0; i < sets[0].nsets; i++)
+    {
+        for (j = 0; j < npoints; j++)
+        {
+            if (sets[i].mode == MEMBERSHIP_INTERLEAVED) degree = sets[i].degrees[j * sets[i].stride + sets[i].term];
+            else degree = sets[i].value[j];
+
+            tables[npoints * i + j] = DegreeToQ15 (degree);
+        }
+
+        aux[i].value = &tables[npoints * i];
+        aux[i].nsets = sets[0].nsets;
+        aux[i].npoints = npoints;
+        aux[i].start_uod = start_uod;
+        aux[i].stop_uod = stop_uod;
+        aux[i].scale = scale;
+        aux[i].step = step;
+        aux[i].arena = raw;
+
+        FixedSupport (&aux[i]);
+    }
+
+    (* fixed) = aux;
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int LoadFixedSets (struct SFixedSets **fixed, const uint16_t *tables, int nsets, long npoints, int32_t start_uod, int32_t stop_uod)
+{
+    int i;
+
+    struct SFixedSets *aux;
+    struct SFixedScale scale;
+    struct SFixedScale step;
+
+    if (nsets < 1)
+    {
+        printf ("\nError: invalid number of sets %d: LoadFixedSets ()\n", nsets);
+        return FALSE;
+    }
+
+    if (! FixedUniverse (&scale, &step, npoints, start_uod, stop_uod, "LoadFixedSets")) return FALSE;
+
+    // only the set structs are allocated, the tables stay where the caller keeps them (flash)
+    aux = (struct SFixedSets *) malloc (sizeof (struct SFixedSets) * nsets);
+    if (aux == NULL)
+    {
+        printf ("\nError on allocating memory: LoadFixedSets ()\n");
+        return FALSE;
+    }
+
+    for (i = 0; i < nsets; i++)
+    {
+        aux[i].value = &tables[npoints * i];
+        aux[i].nsets = nsets;
+        aux[i].npoints = npoints;
+        aux[i].start_uod = start_uod;
+        aux[i].stop_uod = stop_uod;
+        aux[i].scale = scale;
+        aux[i].step = step;
+        aux[i].arena = aux;
+
+        FixedSupport (&aux[i]);
+    }
+
+    (* fixed) = aux;
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void FreeFixedSets (struct SFixedSets *fixed)
+{
+    if (fixed == NULL) return;
+
+    free (fixed[0].arena);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int InitializeFixedInference (struct SFixedInference **inference, long npoints)
+{
+    struct SFixedInference *aux;
+
+    aux = (struct SFixedInference *) malloc (sizeof (struct SFixedInference));
+    if (aux == NULL) return FALSE;
+
+    aux->fuzzy_values = (uint16_t *) calloc (npoints, sizeof (uint16_t));
+    if (aux->fuzzy_values == NULL)
+    {
+        printf ("\nError on allocating memory: InitializeFixedInference ()\n");
+        free (aux);
+        return FALSE;
+    }
+
+    aux->npoints = npoints;
+    aux->first = 0;
+    aux->last = -1;
+
+    (* inference) = aux;
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void FreeFixedInference (struct SFixedInference *inference)
+{
+    if (inference == NULL) return;
+
+    free (inference->fuzzy_values);
+    free (inference);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void ClearFixedInference (struct SFixedInference *inference)
+{
+    if (inference->first <= inference->last)
+        memset (&inference->fuzzy_values[inference->first], 0, sizeof (uint16_t) * (inference->last - inference->first + 1));
+
+    inference->first = 0;
+    inference->last = -1;
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static long FixedPosDisc (const struct SFixedSets *set, int32_t point)
+{
+    uint64_t x;
+    long aprox;
+
+    // same rounding as UniversePosDisc (): nearest point, halves rounded up
+    if (point <= set->start_uod) return 0;
+    if (point >= set->stop_uod) return set->npoints - 1;
+
+    x = ScaleValue (&set->scale, (uint32_t) (point - set->start_uod));
+    aprox = (long) ((x + Q16_ONE / 2) >> 16);
+
+    if (aprox > set->npoints - 1) aprox = set->npoints - 1;
+
+    return aprox;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int32_t FixedPosition (const struct SFixedSets *set, uint32_t position)
+{
+    // position is a point index in Q16.16: start_uod + position * step, as UniverseDiscPos ()
+    return set->start_uod + (int32_t) ScaleValue (&set->step, position);
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+uint16_t FixedDegree (const struct SFixedSets *set, int32_t point)
+{
+    return set->value[FixedPosDisc (set, point)];
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void FixedImplication (struct SFixedInference *inference, const struct SFixedSets *output, uint16_t alpha, int method)
+{
+    long i;
+    long first;
+    long last;
+    uint16_t value;
+    uint16_t lower;
+
+    const uint16_t *set;
+    uint16_t *fuzzy_values;
+
+    if (! CheckImplication (method, "FixedImplication")) return;
+
+    if (output->npoints > inference->npoints)
+    {
+        printf ("\nError: the inference context is smaller than the output set: FixedImplication ()\n");
+        return;
+    }
+
+    // out of its support the membership is 0, so MANDANI and LARSEN leave those points unchanged
+    if (method == ZADEH)
+    {
+        first = 0;
+        last = output->npoints - 1;
+    }
+    else
+    {
+        if (alpha == 0) return;
+
+        first = output->first;
+        last = output->last;
+    }
+
+    if (first > last) return;
+
+    set = output->value;
+    fuzzy_values = inference->fuzzy_values;
+    lower = (uint16_t) (Q15_ONE - alpha);
+
+    switch (method)
+    {
+        case LARSEN:    for (i = first; i <= last; i++)
+                        {
+                            value = (uint16_t) (((uint32_t) set[i] * alpha + Q15_ONE / 2) >> 15);
+                            if (value > fuzzy_values[i]) fuzzy_values[i] = value;
+                        }
+                        break;
+
+        case ZADEH:     for (i = first; i <= last; i++)
+                        {
+                            value = (set[i] < alpha) ? set[i] : alpha;
+                            if (value < lower) value = lower;
+                            if (value > fuzzy_values[i]) fuzzy_values[i] = value;
+                        }
+                        break;
+
+        default:        for (i = first; i <= last; i++)
+                        {
+                            value = (set[i] < alpha) ? set[i] : alpha;
+                            if (value > fuzzy_values[i]) fuzzy_values[i] = value;
+                        }
+                        break;
+    }
+
+    if (inference->first > inference->last)
+    {
+        inference->first = first;
+        inference->last = last;
+    }
+    else
+    {
+        if (first < inference->first) inference->first = first;
+        if (last > inference->last) inference->last = last;
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void FixedIfInput1 (struct SFixedInference *inference, const struct SFixedSets *input_set1, int membership1, int32_t value1,
+                    const struct SFixedSets *output_set, int membership3, int method)
+{
+    if (! CheckImplication (method, "FixedIfInput1")) return;
+
+    FixedImplication (inference, &output_set[membership3], FixedDegree (&input_set1[membership1], value1), method);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void FixedIfInput2 (struct SFixedInference *inference, const struct SFixedSets *input_set1, int membership1, int32_t value1, int op,
+                    const struct SFixedSets *input_set2, int membership2, int32_t value2,
+                    const struct SFixedSets *output_set, int membership3, int method)
+{
+    uint16_t degree1;
+    uint16_t degree2;
+    uint16_t alpha;
+
+    if (! CheckImplication (method, "FixedIfInput2")) return;
+
+    degree1 = FixedDegree (&input_set1[membership1], value1);
+    degree2 = FixedDegree (&input_set2[membership2], value2);
+
+    if (op == AND) alpha = (degree1 < degree2) ? degree1 : degree2;
+    else alpha = (degree1 > degree2) ? degree1 : degree2;
+
+    FixedImplication (inference, &output_set[membership3], alpha, method);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void AddSaturate (uint64_t *total, uint64_t value)
+{
+    *total = (*total > UINT64_MAX - value) ? UINT64_MAX : *total + value;
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void FixedMoments (const uint16_t *values, long npoints, uint64_t *sum, uint64_t *moment)
+{
+    long i;
+    long n;
+    long j;
+    uint32_t block_sum;
+    uint32_t block_moment;
+
+    *sum = 0;
+    *moment = 0;
+
+    // exact 32 bit sums per block (index relative to the block), the block moment is moved to its base
+    // index when it is folded: moment += block_moment + base * block_sum
+    for (i = 0; i < npoints; i = i + FIXED_BLOCK)
+    {
+        n = npoints - i;
+        if (n > FIXED_BLOCK) n = FIXED_BLOCK;
+
+        block_sum = 0;
+        block_moment = 0;
+
+        for (j = 0; j < n; j++)
+        {
+            block_sum += values[i + j];
+            block_moment += (uint32_t) values[i + j] * (uint32_t) j;
+        }
+
+        AddSaturate (sum, block_sum);
+        AddSaturate (moment, block_moment);
+        AddSaturate (moment, (uint64_t) block_sum * (uint64_t) i);
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int32_t FixedDeFuzzy (const struct SFixedInference *inference, const struct SFixedSets *output_set, int method)
+{
+    long i;
+    long first;
+    long last;
+    long first_max;
+    long last_max;
+    uint16_t max;
+    uint64_t sum;
+    uint64_t moment;
+    uint64_t nmax;
+    uint64_t max_moment;
+    uint64_t half;
+
+    const uint16_t *values;
+
+    if (method == COA_ANALYTIC) method = COA;
+    if (method == BOA_ANALYTIC) method = BOA;
+
+    first = inference->first;
+    last = inference->last;
+    if (last > output_set[0].npoints - 1) last = output_set[0].npoints - 1;
+
+    // no rule fired: the aggregated output is empty
+    if (first > last) return 0;
+
+    values = &inference->fuzzy_values[first];
+
+    switch (method)
+    {
+        // positions relative to first, a single division gives the centre in Q16.16
+        case COA:   FixedMoments (values, last - first + 1, &sum, &moment);
+                    if (sum == 0) return 0;
+
+                    return FixedPosition (output_set, (uint32_t) (((uint64_t) first << 16) + ((moment << 16) + sum / 2) / sum));
+
+        case BOA:   FixedMoments (values, last - first + 1, &sum, &moment);
+                    if (sum == 0) return 0;
+
+                    // first point where twice the area on its left reaches the total area
+                    for (half = 0, i = first; i < last; i++)
+                    {
+                        half += inference->fuzzy_values[i];
+                        if (2 * half >= sum) break;
+                    }
+
+                    return FixedPosition (output_set, (uint32_t) i << 16);
+    }
+
+    // MOM, FOM and LOM: all the points with the biggest value
+    max = 0;
+    first_max = 0;
+    last_max = 0;
+    nmax = 0;
+    max_moment = 0;
+
+    for (i = 0; i <= last - first; i++)
+    {
+        if (values[i] > max)
+        {
+            max = values[i];
+            first_max = i;
+            nmax = 0;
+            max_moment = 0;
+        }
+
+        if ((values[i] == max) && (max > 0))
+        {
+            last_max = i;
+            nmax++;
+            max_moment += (uint64_t) i;
+        }
+    }
+
+    if (max == 0) return 0;
+
+    switch (method)
+    {
+        case FOM:   return FixedPosition (output_set, (uint32_t) (first + first_max) << 16);
+
+        case LOM:   return FixedPosition (output_set, (uint32_t) (first + last_max) << 16);
+    }
+
+    return FixedPosition (output_set, (uint32_t) (((uint64_t) first << 16) + ((max_moment << 16) + nmax / 2) / nmax));
+}
+//-------------------------------------------------------------------------------------------------
@@ -39,198 +39,128 @@
 
 #include "implications.h"
 #include "fisutils.h"
+#include "kernels.h"
 
-// for LARSEN and ZADEH, only
-double *ImplicationSet (double *singleton_input_set, double *input_set, double *output_set, long npoints1, long npoints2, int method)
+int CheckImplication (int method, const char *function)
 {
-    long i;
-    long y;
-    double minvalue;
-    double maxvalue;
+    if ((method == MANDANI) || (method == LARSEN) || (method == ZADEH)) return TRUE;
+
+    if (method == TSK) printf ("\nError: TSK is only valid in a rule base: %s ()\n", function);
+    else printf ("\nError: unknown implication method %d: %s ()\n", method, function);
+
+    return FALSE;
+}
 
-    double *aux;
+// implication of a singleton input (the firing degree is read at the singleton position)
+fuzzy_t *ImplicationSet (fuzzy_t *singleton_input_set, fuzzy_t *input_set, fuzzy_t *output_set, long npoints1, long npoints2, int method)
+{
+    fuzzy_t *aux;
+
+    if (! CheckImplication (method, "ImplicationSet")) return NULL;
 
-    aux = (double *) malloc (sizeof (double) * npoints2);
+    aux = (fuzzy_t *) malloc (sizeof (fuzzy_t) * npoints2);
     if (! aux)
     {
         printf ("\nError on allocating memory: ImplicationSet ()\n");
         return NULL;
     }
 
-    switch (method)
-    {
-        case ZADEH:     for (i = 0; i < npoints1; i++)
-                        {
-			 	minvalue = 1;
-				maxvalue = 0;
-
-                            	for (y = 0; y < npoints2; y++)
-                            	{
-					minvalue = Minimum (singleton_input_set[i], Maximum (1.0 - input_set[i], Minimum (input_set[i], output_set[y])));
-					maxvalue = Maximum (minvalue, maxvalue);
-
-                            	}
-
-				aux[i] = maxvalue;
-                        }
-
-                        break;
-
-        case LARSEN:    for (i = 0; i < npoints1; i++)
-                        {
-				minvalue = 1;
-				maxvalue = 0;
-
-                            	for (y = 0; y < npoints2; y++)
-                            	{
-					minvalue = Minimum (singleton_input_set[i], input_set[i] * output_set[y]);
-					maxvalue = Maximum (minvalue, maxvalue);
-
-                            	}
-
-				aux[i] = maxvalue;
-                        }
-
-                        break;
-    }
+    ImplicationInto (aux, singleton_input_set, input_set, output_set, npoints1, npoints2, method);
 
     return aux;
 }
 
-// as MANDANI doesnt use Singleton values, it was implemented separately in the functions below
-void  FuzzyIfInput2 (	struct SSets *input_set1, int membership1, double value1, int op,
-			          			struct SSets *input_set2, int membership2, double value2,
-					           	struct SSets *output_set, int membership3, int method, double **fuzzy_values)
+void ImplicationInto (fuzzy_t *implication, const fuzzy_t *singleton_input_set, const fuzzy_t *input_set, const fuzzy_t *output_set,
+                        long npoints1, long npoints2, int method)
 {
-    double *aux_fuzzy_values = 0;
-    long int i;
-
-    double *singleton_set1 = 0;
-    double *values_set1 = 0;
-
-    double *singleton_set2 = 0;
-    double *values_set2 = 0;
+    long i;
+    double alpha;
 
-    double minmax;
-    long int pos1;
-    long int pos2;
+    if (! CheckImplication (method, "ImplicationInto")) return;
 
-    if (method == MANDANI)
+    // the singleton set is zero but on the crisp input position, so the implication only depends on
+    // the firing degree at that position
+    alpha = 0;
+    for (i = 0; i < npoints1; i++)
     {
-
-        pos1 = ConvPosDisc (value1, input_set1[membership1].npoints, input_set1[membership1].start_uod, input_set1[membership1].stop_uod);
-
-        pos2 = ConvPosDisc (value2, input_set2[membership2].npoints, input_set2[membership2].start_uod, input_set2[membership2].stop_uod);
-
-        value1 = input_set1[membership1].value[pos1];
-        value2 = input_set2[membership2].value[pos2];
-
-        switch (op)
+        if (singleton_input_set[i] > 0)
         {
-            case AND :  minmax = 1.0;
-                        minmax = Minimum (value1, value2);
-                        aux_fuzzy_values = Cut (&output_set[membership3].value, output_set[membership3].npoints, minmax, FALSE);
-                        break;
-
-            case OR :   minmax = 0;
-                        minmax = Maximum (value1, value2);
-                        aux_fuzzy_values = Cut (&output_set[membership3].value, output_set[membership3].npoints, minmax, FALSE);
-						break;
+            alpha = Minimum (singleton_input_set[i], input_set[i]);
+            break;
         }
     }
 
-    else
-    {
-        singleton_set1 = SigletonSet (value1, input_set1[membership1].npoints, input_set1[membership1].start_uod,
-					input_set1[membership1].stop_uod);
-        values_set1 = ImplicationSet (singleton_set1, input_set1[membership1].value, output_set[membership3].value,
-					input_set1[membership1].npoints, output_set[membership3].npoints, method);
-
+    memset (implication, 0, sizeof (fuzzy_t) * npoints2);
 
-		singleton_set2 = SigletonSet (value2, input_set2[membership2].npoints, input_set2[membership2].start_uod,
-						input_set2[membership1].stop_uod);
+    ImplicationKernel (implication, output_set, npoints2, alpha, method);
 
-        values_set2 = ImplicationSet (singleton_set2, input_set2[membership2].value, output_set[membership3].value,
-					input_set2[membership1].npoints, output_set[membership3].npoints, method);
-
-
-        switch (op)
-        {
-            case AND :  for (i = 0; i < input_set1[membership1].npoints; i++)
-                        {
-                            aux_fuzzy_values[i] = Minimum (values_set1[i], values_set2[i]);
-                        }
+    return;
+}
 
-                        break;
+// implication of a fired rule (alpha = firing strength), aggregated (maximum) in fuzzy_values
+static void RuleImplication (double alpha, const struct SSets *output_set, int membership3, int method, fuzzy_t **fuzzy_values)
+{
+    ImplicationKernel (* fuzzy_values, output_set[membership3].value, output_set[membership3].npoints, alpha, method);
 
-            case OR :   for (i = 0; i < input_set1[membership1].npoints; i++)
-                        {
-                            aux_fuzzy_values[i] = Maximum (values_set1[i], values_set2[i]);
-                        }
+    return;
+}
 
-                        break;
-        }
+// the input is a singleton (crisp value), so every method only needs the membership degree of the
+// input: the antecedents are combined (AND/OR) in the firing strength and the output set is clipped
+// (MANDANI), scaled (LARSEN) or transformed (ZADEH) in one pass
+void  FuzzyIfInput2 (	const struct SSets *input_set1, int membership1, double value1, int op,
+			          			const struct SSets *input_set2, int membership2, double value2,
+					           	const struct SSets *output_set, int membership3, int method, fuzzy_t **fuzzy_values)
+{
+    double minmax;
 
-        free (singleton_set1);
-		free (singleton_set2);
-        free (values_set1);
-		free (values_set2);
-    }
+    if (! CheckImplication (method, "FuzzyIfInput2")) return;
 
-    for (i = 0; i < output_set[membership3].npoints; i++)
-    {
-        (* fuzzy_values)[i] = Maximum((* fuzzy_values)[i], aux_fuzzy_values[i]);
-    }
+    value1 = MembershipDegree (&input_set1[membership1], value1);
+    value2 = MembershipDegree (&input_set2[membership2], value2);
 
-    free (aux_fuzzy_values);
+    if (op == AND) minmax = Minimum (value1, value2);
+    else minmax = Maximum (value1, value2);
 
+    RuleImplication (minmax, output_set, membership3, method, fuzzy_values);
 
     return;
 }
 
-void  FuzzyIfInput1 (	struct SSets *input_set1, int membership1, double value1,
-				        		struct SSets *output_set, int membership3, int method, double **fuzzy_values)
+void  FuzzyIfInput1 (	const struct SSets *input_set1, int membership1, double value1,
+				        		const struct SSets *output_set, int membership3, int method, fuzzy_t **fuzzy_values)
 {
-    double *aux_fuzzy_values = 0;
-    long int i;
-
-    double *singleton_set1 = 0;
-    double *values_set1 = 0;
-
-    long int pos1;
-
-    if (method == MANDANI)
-    {
+    if (! CheckImplication (method, "FuzzyIfInput1")) return;
 
-        pos1 = ConvPosDisc (value1, input_set1[membership1].npoints, input_set1[membership1].start_uod, input_set1[membership1].stop_uod);
+    value1 = MembershipDegree (&input_set1[membership1], value1);
 
-        value1 = input_set1[membership1].value[pos1];
+    RuleImplication (value1, output_set, membership3, method, fuzzy_values);
 
-	aux_fuzzy_values = Cut (&output_set[membership3].value, output_set[membership3].npoints, value1, FALSE);
+	return;
+}
 
-    }
+void  FuzzyIfVector1 (	const fuzzy_t *degrees1, int membership1,
+				        		const struct SSets *output_set, int membership3, int method, fuzzy_t **fuzzy_values)
+{
+    if (! CheckImplication (method, "FuzzyIfVector1")) return;
 
-    else
-    {
-        singleton_set1 = SigletonSet (value1, input_set1[membership1].npoints, input_set1[membership1].start_uod,
-					input_set1[membership1].stop_uod);
-        values_set1 = ImplicationSet (singleton_set1, input_set1[membership1].value, output_set[membership3].value,
-					input_set1[membership1].npoints, output_set[membership3].npoints, method);
+    RuleImplication (degrees1[membership1], output_set, membership3, method, fuzzy_values);
 
-		for (i = 0; i < input_set1[membership1].npoints; i++)
-		    aux_fuzzy_values[i] = values_set1[i];
+    return;
+}
 
-        free (singleton_set1);
-        free (values_set1);
-    }
+void  FuzzyIfVector2 (	const fuzzy_t *degrees1, int membership1, int op,
+			          			const fuzzy_t *degrees2, int membership2,
+					           	const struct SSets *output_set, int membership3, int method, fuzzy_t **fuzzy_values)
+{
+    double minmax;
 
-    for (i = 0; i < output_set[membership3].npoints; i++)
-    {
-        (* fuzzy_values)[i] = Maximum((* fuzzy_values)[i], aux_fuzzy_values[i]);
-    }
+    if (! CheckImplication (method, "FuzzyIfVector2")) return;
 
-    free (aux_fuzzy_values);
+    if (op == AND) minmax = Minimum (degrees1[membership1], degrees2[membership2]);
+    else minmax = Maximum (degrees1[membership1], degrees2[membership2]);
 
+    RuleImplication (minmax, output_set, membership3, method, fuzzy_values);
 
-	return;
+    return;
 }
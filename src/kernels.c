@@ -0,0 +1,1618 @@
+/**
+ * @file
+ * @author  Andre Silva <andreluizeng@yahoo.com.br>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2012, Andre Luiz Vieira da Silva
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this software
+ *    must display the following acknowledgement:
+ *    This product includes software developed by the <organization>.
+ * 4. Neither the name of the <organization> nor the
+ *    names of its contributors may be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Andre Silva ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Andre Silva BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @section DESCRIPTION
+ *
+ */
+
+#include "kernels.h"
+#include "fisutils.h"
+
+#if (defined (__x86_64__) || defined (__i386__)) && defined (__GNUC__)
+#define KERNELS_X86
+#include <immintrin.h>
+#endif
+
+// exp () approximation constants (Cody-Waite reduction + degree 12 Taylor polynomial)
+#define EXP_MIN_ARG     -708.0
+#define EXP_LOG2E       1.44269504088896338700e+00
+#define EXP_LN2_HI      6.93147180369123816490e-01
+#define EXP_LN2_LO      1.90821492927058770002e-10
+
+#define EXP_C2          (1.0 / 2.0)       // Taylor coefficients 1 / k!
+#define EXP_C3          (1.0 / 6.0)
+#define EXP_C4          (1.0 / 24.0)
+#define EXP_C5          (1.0 / 120.0)
+#define EXP_C6          (1.0 / 720.0)
+#define EXP_C7          (1.0 / 5040.0)
+#define EXP_C8          (1.0 / 40320.0)
+#define EXP_C9          (1.0 / 362880.0)
+#define EXP_C10         (1.0 / 3628800.0)
+#define EXP_C11         (1.0 / 39916800.0)
+#define EXP_C12         (1.0 / 479001600.0)
+
+// points reduced per block by ReductionKernel () before the pairwise sum of the blocks
+#define REDUCTION_BLOCK 256
+#define PAIRWISE_DEPTH  64
+
+// biggest element index of the 32 bit gathers (LookupAVX2 ())
+#define GATHER_MAX_INDEX    2147483647.0
+
+// the only mutable state of the library: written once by KernelLevel () (every thread detects the
+// same value) or by SetKernelLevel (), read with relaxed atomics so concurrent inferences don't race
+#ifdef __GNUC__
+#define LOAD_LEVEL()        __atomic_load_n (&kernel_level, __ATOMIC_RELAXED)
+#define STORE_LEVEL(level)  __atomic_store_n (&kernel_level, (level), __ATOMIC_RELAXED)
+#else
+#define LOAD_LEVEL()        (kernel_level)
+#define STORE_LEVEL(level)  (kernel_level = (level))
+#endif
+
+static int kernel_level = -1;
+
+// TRIANGULAR and TRAPEZOIDAL are both handled as a trapezoid x1 <= x2 <= x3 <= x4
+struct SShape
+{
+    double x1;
+    double x2;
+    double x3;
+    double x4;
+    double inv_rise;    // 1 / (x2 - x1), 0 if the rising edge is empty
+    double inv_fall;    // 1 / (x4 - x3), 0 if the falling edge is empty
+    double center;
+    double inv_sigma2;  // 1 / sigma^2
+};
+
+//-------------------------------------------------------------------------------------------------
+static void ShapeParams (int type, const double *params, struct SShape *shape)
+{
+    memset (shape, 0, sizeof (struct SShape));
+
+    switch (type)
+    {
+        case TRIANGULAR:    shape->x1 = params[0];
+                            shape->x2 = params[1];
+                            shape->x3 = params[1];
+                            shape->x4 = params[2];
+                            break;
+
+        case TRAPEZOIDAL:   shape->x1 = params[0];
+                            shape->x2 = params[1];
+                            shape->x3 = params[2];
+                            shape->x4 = params[3];
+                            break;
+
+        case GAUSSIAN:      shape->center = params[0];
+                            shape->inv_sigma2 = 1.0 / (params[1] * params[1]);
+                            return;
+    }
+
+    if (shape->x2 > shape->x1) shape->inv_rise = 1.0 / (shape->x2 - shape->x1);
+    if (shape->x4 > shape->x3) shape->inv_fall = 1.0 / (shape->x4 - shape->x3);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void MembershipScalar (fuzzy_t *values, long npoints, double start_uod, double step, int type, const struct SShape *shape)
+{
+    long i;
+    double x;
+    double d;
+
+    if (type == GAUSSIAN)
+    {
+        for (i = 0; i < npoints; i++)
+        {
+            x = start_uod + (double) i * step;
+            d = x - shape->center;
+            values[i] = exp (-(d * d) * shape->inv_sigma2);
+        }
+
+        return;
+    }
+
+    for (i = 0; i < npoints; i++)
+    {
+        x = start_uod + (double) i * step;
+
+        if ((x < shape->x1) || (x >= shape->x4)) values[i] = 0;
+        else if (x >= shape->x3) values[i] = (shape->x4 - x) * shape->inv_fall;
+        else if (x < shape->x2) values[i] = (x - shape->x1) * shape->inv_rise;
+        else values[i] = 1;
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void ClipMaxScalar (fuzzy_t *fuzzy_values, const fuzzy_t *set, long npoints, double alpha)
+{
+    long i;
+    fuzzy_t level;
+    fuzzy_t value;
+
+    // alpha rounded to the element type, as in the SIMD kernels
+    level = (fuzzy_t) alpha;
+
+    for (i = 0; i < npoints; i++)
+    {
+        value = (set[i] < level) ? set[i] : level;
+        fuzzy_values[i] = (fuzzy_values[i] > value) ? fuzzy_values[i] : value;
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void ImplicationScalar (fuzzy_t *fuzzy_values, const fuzzy_t *set, long npoints, double alpha, int method)
+{
+    long i;
+    fuzzy_t level;
+    fuzzy_t lower;
+    fuzzy_t residue;
+    fuzzy_t value;
+
+    level = (fuzzy_t) alpha;
+    lower = (fuzzy_t) (1.0 - alpha);
+
+    // LARSEN with alpha = level + residue (residue is 0 in double), so a single precision vector is not
+    // scaled by alpha rounded to float: the same operations as the SIMD kernels
+    residue = (fuzzy_t) (alpha - (double) level);
+
+    for (i = 0; i < npoints; i++)
+    {
+        if (method == LARSEN)
+        {
+            value = level * set[i] + residue * set[i];
+        }
+
+        else
+        {
+            value = (set[i] < level) ? set[i] : level;
+            value = (value > lower) ? value : lower;
+        }
+
+        fuzzy_values[i] = (fuzzy_values[i] > value) ? fuzzy_values[i] : value;
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void OperatorScalar (double *values, const double *operand, long n, int op)
+{
+    long i;
+
+    if (op == AND)
+    {
+        for (i = 0; i < n; i++) values[i] = (operand[i] < values[i]) ? operand[i] : values[i];
+    }
+    else
+    {
+        for (i = 0; i < n; i++) values[i] = (operand[i] > values[i]) ? operand[i] : values[i];
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void LookupScalar (double *degrees, const fuzzy_t *column, long stride, const struct SUniverse *universe, const double *points, long n)
+{
+    long i;
+
+    for (i = 0; i < n; i++) degrees[i] = column[UniversePosDisc (universe, points[i]) * stride];
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void MergeMaximum (struct SReduction *reduction, double max, long first, long last, long count, double moment)
+{
+    if (count == 0) return;
+
+    if (max > reduction->max)
+    {
+        reduction->max = max;
+        reduction->first_max = first;
+        reduction->last_max = last;
+        reduction->nmax = count;
+        reduction->max_moment = moment;
+    }
+
+    else if (max == reduction->max)
+    {
+        if (first < reduction->first_max) reduction->first_max = first;
+        if (last > reduction->last_max) reduction->last_max = last;
+        reduction->nmax += count;
+        reduction->max_moment += moment;
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void ResetReduction (struct SReduction *reduction)
+{
+    memset (reduction, 0, sizeof (struct SReduction));
+    reduction->max = -HUGE_VAL;
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void ReductionScalar (const fuzzy_t *fuzzy_values, long npoints, long base, struct SReduction *reduction)
+{
+    long i;
+    double position;
+    double sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+    double moment0 = 0, moment1 = 0, moment2 = 0, moment3 = 0;
+
+    // base is the index of fuzzy_values[0] in the whole vector. Four lanes added as (0 + 1) + (2 + 3), the
+    // order of the SSE2 and AVX2 kernels, so every level gives the same sums
+    for (i = 0; i + 4 <= npoints; i += 4)
+    {
+        position = (double) (base + i);
+
+        sum0 += fuzzy_values[i];
+        sum1 += fuzzy_values[i + 1];
+        sum2 += fuzzy_values[i + 2];
+        sum3 += fuzzy_values[i + 3];
+
+        moment0 += fuzzy_values[i] * position;
+        moment1 += fuzzy_values[i + 1] * (position + 1.0);
+        moment2 += fuzzy_values[i + 2] * (position + 2.0);
+        moment3 += fuzzy_values[i + 3] * (position + 3.0);
+
+        MergeMaximum (reduction, fuzzy_values[i], base + i, base + i, 1, position);
+        MergeMaximum (reduction, fuzzy_values[i + 1], base + i + 1, base + i + 1, 1, position + 1.0);
+        MergeMaximum (reduction, fuzzy_values[i + 2], base + i + 2, base + i + 2, 1, position + 2.0);
+        MergeMaximum (reduction, fuzzy_values[i + 3], base + i + 3, base + i + 3, 1, position + 3.0);
+    }
+
+    reduction->sum = (sum0 + sum1) + (sum2 + sum3);
+    reduction->moment = (moment0 + moment1) + (moment2 + moment3);
+
+    for (; i < npoints; i++)
+    {
+        position = (double) (base + i);
+
+        reduction->sum += fuzzy_values[i];
+        reduction->moment += fuzzy_values[i] * position;
+
+        MergeMaximum (reduction, fuzzy_values[i], base + i, base + i, 1, position);
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void MomentScalar (const fuzzy_t *values, long npoints, long base, double *sum, double *moment)
+{
+    long i;
+    double position;
+    double sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+    double moment0 = 0, moment1 = 0, moment2 = 0, moment3 = 0;
+
+    // the lanes of ReductionScalar ()
+    for (i = 0; i + 4 <= npoints; i += 4)
+    {
+        position = (double) (base + i);
+
+        sum0 += values[i];
+        sum1 += values[i + 1];
+        sum2 += values[i + 2];
+        sum3 += values[i + 3];
+
+        moment0 += values[i] * position;
+        moment1 += values[i + 1] * (position + 1.0);
+        moment2 += values[i + 2] * (position + 2.0);
+        moment3 += values[i + 3] * (position + 3.0);
+    }
+
+    *sum = (sum0 + sum1) + (sum2 + sum3);
+    *moment = (moment0 + moment1) + (moment2 + moment3);
+
+    for (; i < npoints; i++)
+    {
+        *sum += values[i];
+        *moment += values[i] * (double) (base + i);
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+#ifdef KERNELS_X86
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("sse2")))
+static inline __m128d ExpSSE2 (__m128d a)
+{
+    __m128d under;
+    __m128d n;
+    __m128d r;
+    __m128d p;
+    __m128i e;
+
+    const __m128d round = _mm_set1_pd (6755399441055744.0);   // 2^52 + 2^51
+
+    under = _mm_cmplt_pd (a, _mm_set1_pd (EXP_MIN_ARG));
+    a = _mm_max_pd (a, _mm_set1_pd (EXP_MIN_ARG));
+
+    // a = n * ln(2) + r, |r| <= ln(2) / 2
+    n = _mm_sub_pd (_mm_add_pd (_mm_mul_pd (a, _mm_set1_pd (EXP_LOG2E)), round), round);
+    r = _mm_sub_pd (a, _mm_mul_pd (n, _mm_set1_pd (EXP_LN2_HI)));
+    r = _mm_sub_pd (r, _mm_mul_pd (n, _mm_set1_pd (EXP_LN2_LO)));
+
+    p = _mm_add_pd (_mm_mul_pd (_mm_set1_pd (EXP_C12), r), _mm_set1_pd (EXP_C11));
+    p = _mm_add_pd (_mm_mul_pd (p, r), _mm_set1_pd (EXP_C10));
+    p = _mm_add_pd (_mm_mul_pd (p, r), _mm_set1_pd (EXP_C9));
+    p = _mm_add_pd (_mm_mul_pd (p, r), _mm_set1_pd (EXP_C8));
+    p = _mm_add_pd (_mm_mul_pd (p, r), _mm_set1_pd (EXP_C7));
+    p = _mm_add_pd (_mm_mul_pd (p, r), _mm_set1_pd (EXP_C6));
+    p = _mm_add_pd (_mm_mul_pd (p, r), _mm_set1_pd (EXP_C5));
+    p = _mm_add_pd (_mm_mul_pd (p, r), _mm_set1_pd (EXP_C4));
+    p = _mm_add_pd (_mm_mul_pd (p, r), _mm_set1_pd (EXP_C3));
+    p = _mm_add_pd (_mm_mul_pd (p, r), _mm_set1_pd (EXP_C2));
+    p = _mm_add_pd (_mm_mul_pd (p, r), _mm_set1_pd (1.0));
+    p = _mm_add_pd (_mm_mul_pd (p, r), _mm_set1_pd (1.0));
+
+    // 2^n built directly in the exponent bits (n >= -1022, so it is never denormal)
+    e = _mm_add_epi32 (_mm_cvtpd_epi32 (n), _mm_set1_epi32 (1023));
+    e = _mm_slli_epi64 (_mm_unpacklo_epi32 (e, _mm_setzero_si128 ()), 52);
+
+    return _mm_andnot_pd (under, _mm_mul_pd (p, _mm_castsi128_pd (e)));
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("sse2")))
+static inline __m128d BlendSSE2 (__m128d a, __m128d b, __m128d mask)
+{
+    return _mm_or_pd (_mm_and_pd (mask, b), _mm_andnot_pd (mask, a));
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// 2 fuzzy_t values in double lanes (single precision vectors are widened when loaded and rounded when stored)
+__attribute__ ((target ("sse2")))
+static inline __m128d LoadSSE2 (const fuzzy_t *values)
+{
+#ifdef OPENFUZZ_FLOAT
+    return _mm_cvtps_pd (_mm_castsi128_ps (_mm_loadl_epi64 ((const __m128i *) values)));
+#else
+    return _mm_loadu_pd (values);
+#endif
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("sse2")))
+static inline void StoreSSE2 (fuzzy_t *values, __m128d x)
+{
+#ifdef OPENFUZZ_FLOAT
+    _mm_storel_epi64 ((__m128i *) values, _mm_castps_si128 (_mm_cvtpd_ps (x)));
+#else
+    _mm_storeu_pd (values, x);
+#endif
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("sse2")))
+static inline __m128d ShapeSSE2 (__m128d x, int type, const struct SShape *shape)
+{
+    __m128d mu;
+    __m128d d;
+    __m128d out;
+
+    if (type == GAUSSIAN)
+    {
+        d = _mm_sub_pd (x, _mm_set1_pd (shape->center));
+        return ExpSSE2 (_mm_mul_pd (_mm_sub_pd (_mm_setzero_pd (), _mm_mul_pd (d, d)), _mm_set1_pd (shape->inv_sigma2)));
+    }
+
+    mu = _mm_set1_pd (1.0);
+    mu = BlendSSE2 (mu, _mm_mul_pd (_mm_sub_pd (x, _mm_set1_pd (shape->x1)), _mm_set1_pd (shape->inv_rise)),
+                    _mm_cmplt_pd (x, _mm_set1_pd (shape->x2)));
+    mu = BlendSSE2 (mu, _mm_mul_pd (_mm_sub_pd (_mm_set1_pd (shape->x4), x), _mm_set1_pd (shape->inv_fall)),
+                    _mm_cmpge_pd (x, _mm_set1_pd (shape->x3)));
+
+    out = _mm_or_pd (_mm_cmplt_pd (x, _mm_set1_pd (shape->x1)), _mm_cmpge_pd (x, _mm_set1_pd (shape->x4)));
+
+    return _mm_andnot_pd (out, mu);
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("sse2")))
+static void MembershipSSE2 (fuzzy_t *values, long npoints, double start_uod, double step, int type, const struct SShape *shape)
+{
+    long i;
+    double tail[2];
+
+    __m128d index = _mm_set_pd (1.0, 0.0);
+    __m128d start = _mm_set1_pd (start_uod);
+    __m128d vstep = _mm_set1_pd (step);
+    __m128d mu;
+
+    for (i = 0; i + 2 <= npoints; i += 2)
+    {
+        mu = ShapeSSE2 (_mm_add_pd (start, _mm_mul_pd (index, vstep)), type, shape);
+        StoreSSE2 (&values[i], mu);
+        index = _mm_add_pd (index, _mm_set1_pd (2.0));
+    }
+
+    if (i < npoints)
+    {
+        mu = ShapeSSE2 (_mm_add_pd (start, _mm_mul_pd (index, vstep)), type, shape);
+        _mm_storeu_pd (tail, mu);
+        values[i] = tail[0];
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+#ifdef OPENFUZZ_FLOAT
+
+//-------------------------------------------------------------------------------------------------
+// single precision: 4 points per instruction
+__attribute__ ((target ("sse2")))
+static void ClipMaxSSE2 (fuzzy_t *fuzzy_values, const fuzzy_t *set, long npoints, double alpha)
+{
+    long i;
+    __m128 valpha = _mm_set1_ps ((float) alpha);
+
+    for (i = 0; i + 8 <= npoints; i += 8)
+    {
+        _mm_storeu_ps (&fuzzy_values[i], _mm_max_ps (_mm_loadu_ps (&fuzzy_values[i]), _mm_min_ps (_mm_loadu_ps (&set[i]), valpha)));
+        _mm_storeu_ps (&fuzzy_values[i + 4], _mm_max_ps (_mm_loadu_ps (&fuzzy_values[i + 4]), _mm_min_ps (_mm_loadu_ps (&set[i + 4]), valpha)));
+    }
+
+    ClipMaxScalar (&fuzzy_values[i], &set[i], npoints - i, alpha);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("sse2")))
+static void ImplicationSSE2 (fuzzy_t *fuzzy_values, const fuzzy_t *set, long npoints, double alpha, int method)
+{
+    long i;
+    __m128 value;
+    __m128 valpha = _mm_set1_ps ((float) alpha);
+    __m128 vfloor = _mm_set1_ps ((method == LARSEN) ? 0.0f : (float) (1.0 - alpha));
+    __m128 vresidue = _mm_set1_ps ((float) (alpha - (double) (float) alpha));
+
+    // LARSEN as ImplicationScalar (): set * level + set * residue
+    for (i = 0; i + 4 <= npoints; i += 4)
+    {
+        if (method == LARSEN)
+        {
+            value = _mm_loadu_ps (&set[i]);
+            value = _mm_add_ps (_mm_mul_ps (value, valpha), _mm_mul_ps (value, vresidue));
+        }
+        else value = _mm_max_ps (_mm_min_ps (_mm_loadu_ps (&set[i]), valpha), vfloor);
+
+        _mm_storeu_ps (&fuzzy_values[i], _mm_max_ps (_mm_loadu_ps (&fuzzy_values[i]), value));
+    }
+
+    ImplicationScalar (&fuzzy_values[i], &set[i], npoints - i, alpha, method);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+#else
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("sse2")))
+static void ClipMaxSSE2 (fuzzy_t *fuzzy_values, const fuzzy_t *set, long npoints, double alpha)
+{
+    long i;
+    __m128d valpha = _mm_set1_pd (alpha);
+
+    for (i = 0; i + 4 <= npoints; i += 4)
+    {
+        _mm_storeu_pd (&fuzzy_values[i], _mm_max_pd (_mm_loadu_pd (&fuzzy_values[i]), _mm_min_pd (_mm_loadu_pd (&set[i]), valpha)));
+        _mm_storeu_pd (&fuzzy_values[i + 2], _mm_max_pd (_mm_loadu_pd (&fuzzy_values[i + 2]), _mm_min_pd (_mm_loadu_pd (&set[i + 2]), valpha)));
+    }
+
+    ClipMaxScalar (&fuzzy_values[i], &set[i], npoints - i, alpha);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("sse2")))
+static void ImplicationSSE2 (fuzzy_t *fuzzy_values, const fuzzy_t *set, long npoints, double alpha, int method)
+{
+    long i;
+    __m128d value;
+    __m128d valpha = _mm_set1_pd (alpha);
+    __m128d vfloor = _mm_set1_pd ((method == LARSEN) ? 0.0 : 1.0 - alpha);
+
+    for (i = 0; i + 2 <= npoints; i += 2)
+    {
+        if (method == LARSEN) value = _mm_mul_pd (_mm_loadu_pd (&set[i]), valpha);
+        else value = _mm_max_pd (_mm_min_pd (_mm_loadu_pd (&set[i]), valpha), vfloor);
+
+        _mm_storeu_pd (&fuzzy_values[i], _mm_max_pd (_mm_loadu_pd (&fuzzy_values[i]), value));
+    }
+
+    ImplicationScalar (&fuzzy_values[i], &set[i], npoints - i, alpha, method);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("sse2")))
+static void OperatorSSE2 (double *values, const double *operand, long n, int op)
+{
+    long i;
+
+    for (i = 0; i + 2 <= n; i += 2)
+    {
+        if (op == AND) _mm_storeu_pd (&values[i], _mm_min_pd (_mm_loadu_pd (&operand[i]), _mm_loadu_pd (&values[i])));
+        else _mm_storeu_pd (&values[i], _mm_max_pd (_mm_loadu_pd (&operand[i]), _mm_loadu_pd (&values[i])));
+    }
+
+    OperatorScalar (&values[i], &operand[i], n - i, op);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("sse2")))
+static void ShapePointsSSE2 (double *degrees, const double *points, long n, int type, const struct SShape *shape)
+{
+    long i;
+
+    for (i = 0; i + 2 <= n; i += 2)
+        _mm_storeu_pd (&degrees[i], ShapeSSE2 (_mm_loadu_pd (&points[i]), type, shape));
+
+    if (i < n) _mm_store_sd (&degrees[i], ShapeSSE2 (_mm_set1_pd (points[i]), type, shape));
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// 4 fuzzy_t values in double lanes
+__attribute__ ((target ("avx2,fma")))
+static inline __m256d LoadAVX2 (const fuzzy_t *values)
+{
+#ifdef OPENFUZZ_FLOAT
+    return _mm256_cvtps_pd (_mm_loadu_ps (values));
+#else
+    return _mm256_loadu_pd (values);
+#endif
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("avx2,fma")))
+static inline void StoreAVX2 (fuzzy_t *values, __m256d x)
+{
+#ifdef OPENFUZZ_FLOAT
+    _mm_storeu_ps (values, _mm256_cvtpd_ps (x));
+#else
+    _mm256_storeu_pd (values, x);
+#endif
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// 4 fuzzy_t values of a table gathered at 32 bit indexes, in double lanes
+__attribute__ ((target ("avx2,fma")))
+static inline __m256d GatherAVX2 (const fuzzy_t *column, __m128i index)
+{
+#ifdef OPENFUZZ_FLOAT
+    return _mm256_cvtps_pd (_mm_mask_i32gather_ps (_mm_setzero_ps (), column, index, _mm_castsi128_ps (_mm_set1_epi32 (-1)), 4));
+#else
+    return _mm256_mask_i32gather_pd (_mm256_setzero_pd (), column, index, _mm256_castsi256_pd (_mm256_set1_epi64x (-1)), 8);
+#endif
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("avx2,fma")))
+static inline __m256d ExpAVX2 (__m256d a)
+{
+    __m256d under;
+    __m256d n;
+    __m256d r;
+    __m256d p;
+    __m256i e;
+
+    under = _mm256_cmp_pd (a, _mm256_set1_pd (EXP_MIN_ARG), _CMP_LT_OQ);
+    a = _mm256_max_pd (a, _mm256_set1_pd (EXP_MIN_ARG));
+
+    // a = n * ln(2) + r, |r| <= ln(2) / 2
+    n = _mm256_round_pd (_mm256_mul_pd (a, _mm256_set1_pd (EXP_LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    r = _mm256_fnmadd_pd (n, _mm256_set1_pd (EXP_LN2_HI), a);
+    r = _mm256_fnmadd_pd (n, _mm256_set1_pd (EXP_LN2_LO), r);
+
+    p = _mm256_fmadd_pd (_mm256_set1_pd (EXP_C12), r, _mm256_set1_pd (EXP_C11));
+    p = _mm256_fmadd_pd (p, r, _mm256_set1_pd (EXP_C10));
+    p = _mm256_fmadd_pd (p, r, _mm256_set1_pd (EXP_C9));
+    p = _mm256_fmadd_pd (p, r, _mm256_set1_pd (EXP_C8));
+    p = _mm256_fmadd_pd (p, r, _mm256_set1_pd (EXP_C7));
+    p = _mm256_fmadd_pd (p, r, _mm256_set1_pd (EXP_C6));
+    p = _mm256_fmadd_pd (p, r, _mm256_set1_pd (EXP_C5));
+    p = _mm256_fmadd_pd (p, r, _mm256_set1_pd (EXP_C4));
+    p = _mm256_fmadd_pd (p, r, _mm256_set1_pd (EXP_C3));
+    p = _mm256_fmadd_pd (p, r, _mm256_set1_pd (EXP_C2));
+    p = _mm256_fmadd_pd (p, r, _mm256_set1_pd (1.0));
+    p = _mm256_fmadd_pd (p, r, _mm256_set1_pd (1.0));
+
+    // 2^n built directly in the exponent bits (n >= -1022, so it is never denormal)
+    e = _mm256_cvtepi32_epi64 (_mm_add_epi32 (_mm256_cvtpd_epi32 (n), _mm_set1_epi32 (1023)));
+    e = _mm256_slli_epi64 (e, 52);
+
+    return _mm256_andnot_pd (under, _mm256_mul_pd (p, _mm256_castsi256_pd (e)));
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("avx2,fma")))
+static inline __m256d ShapeAVX2 (__m256d x, int type, const struct SShape *shape)
+{
+    __m256d mu;
+    __m256d d;
+    __m256d out;
+
+    if (type == GAUSSIAN)
+    {
+        d = _mm256_sub_pd (x, _mm256_set1_pd (shape->center));
+        return ExpAVX2 (_mm256_mul_pd (_mm256_sub_pd (_mm256_setzero_pd (), _mm256_mul_pd (d, d)), _mm256_set1_pd (shape->inv_sigma2)));
+    }
+
+    mu = _mm256_set1_pd (1.0);
+    mu = _mm256_blendv_pd (mu, _mm256_mul_pd (_mm256_sub_pd (x, _mm256_set1_pd (shape->x1)), _mm256_set1_pd (shape->inv_rise)),
+                           _mm256_cmp_pd (x, _mm256_set1_pd (shape->x2), _CMP_LT_OQ));
+    mu = _mm256_blendv_pd (mu, _mm256_mul_pd (_mm256_sub_pd (_mm256_set1_pd (shape->x4), x), _mm256_set1_pd (shape->inv_fall)),
+                           _mm256_cmp_pd (x, _mm256_set1_pd (shape->x3), _CMP_GE_OQ));
+
+    out = _mm256_or_pd (_mm256_cmp_pd (x, _mm256_set1_pd (shape->x1), _CMP_LT_OQ),
+                        _mm256_cmp_pd (x, _mm256_set1_pd (shape->x4), _CMP_GE_OQ));
+
+    return _mm256_andnot_pd (out, mu);
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// points start_uod + i * step rounded as MembershipScalar (): the empty asm keeps the compiler from
+// contracting the product and the sum into one FMA, so every level computes the same table
+__attribute__ ((target ("avx2,fma")))
+static inline __m256d GridAVX2 (__m256d start, __m256d index, __m256d vstep)
+{
+    __m256d offset = _mm256_mul_pd (index, vstep);
+
+    __asm__ ("" : "+x" (offset));
+
+    return _mm256_add_pd (start, offset);
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// x * index rounded before it is added to the moment, as in the scalar and SSE2 kernels (the empty asm
+// keeps the compiler from contracting it into an FMA)
+__attribute__ ((target ("avx2,fma")))
+static inline __m256d ProductAVX2 (__m256d x, __m256d index)
+{
+    __m256d product = _mm256_mul_pd (x, index);
+
+    __asm__ ("" : "+x" (product));
+
+    return product;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// the same for the points after the last full vector
+__attribute__ ((target ("avx2,fma")))
+static inline double TailProductAVX2 (double x, double position)
+{
+    double product = x * position;
+
+    __asm__ ("" : "+x" (product));
+
+    return product;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("avx2,fma")))
+static void MembershipAVX2 (fuzzy_t *values, long npoints, double start_uod, double step, int type, const struct SShape *shape)
+{
+    long i;
+    long j;
+    double tail[4];
+
+    __m256d index = _mm256_set_pd (3.0, 2.0, 1.0, 0.0);
+    __m256d start = _mm256_set1_pd (start_uod);
+    __m256d vstep = _mm256_set1_pd (step);
+    __m256d mu;
+
+    for (i = 0; i + 4 <= npoints; i += 4)
+    {
+        mu = ShapeAVX2 (GridAVX2 (start, index, vstep), type, shape);
+        StoreAVX2 (&values[i], mu);
+        index = _mm256_add_pd (index, _mm256_set1_pd (4.0));
+    }
+
+    if (i < npoints)
+    {
+        mu = ShapeAVX2 (GridAVX2 (start, index, vstep), type, shape);
+        _mm256_storeu_pd (tail, mu);
+        for (j = 0; i < npoints; i++, j++) values[i] = tail[j];
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+#ifdef OPENFUZZ_FLOAT
+
+//-------------------------------------------------------------------------------------------------
+// single precision: 8 points per instruction
+__attribute__ ((target ("avx2,fma")))
+static void ClipMaxAVX2 (fuzzy_t *fuzzy_values, const fuzzy_t *set, long npoints, double alpha)
+{
+    long i;
+    __m256 valpha = _mm256_set1_ps ((float) alpha);
+
+    for (i = 0; i + 16 <= npoints; i += 16)
+    {
+        _mm256_storeu_ps (&fuzzy_values[i], _mm256_max_ps (_mm256_loadu_ps (&fuzzy_values[i]), _mm256_min_ps (_mm256_loadu_ps (&set[i]), valpha)));
+        _mm256_storeu_ps (&fuzzy_values[i + 8], _mm256_max_ps (_mm256_loadu_ps (&fuzzy_values[i + 8]), _mm256_min_ps (_mm256_loadu_ps (&set[i + 8]), valpha)));
+    }
+
+    ClipMaxScalar (&fuzzy_values[i], &set[i], npoints - i, alpha);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("avx2,fma")))
+static void ImplicationAVX2 (fuzzy_t *fuzzy_values, const fuzzy_t *set, long npoints, double alpha, int method)
+{
+    long i;
+    __m256 value;
+    __m256 valpha = _mm256_set1_ps ((float) alpha);
+    __m256 vfloor = _mm256_set1_ps ((method == LARSEN) ? 0.0f : (float) (1.0 - alpha));
+
+    __m256 vresidue = _mm256_set1_ps ((float) (alpha - (double) (float) alpha));
+    __m256 high;
+    __m256 low;
+
+    // LARSEN as ImplicationScalar (): set * level + set * residue (the empty asm keeps the compiler from
+    // contracting one of the products and the sum into an FMA)
+    for (i = 0; i + 8 <= npoints; i += 8)
+    {
+        if (method == LARSEN)
+        {
+            value = _mm256_loadu_ps (&set[i]);
+            high = _mm256_mul_ps (value, valpha);
+            low = _mm256_mul_ps (value, vresidue);
+            __asm__ ("" : "+x" (high), "+x" (low));
+            value = _mm256_add_ps (high, low);
+        }
+        else value = _mm256_max_ps (_mm256_min_ps (_mm256_loadu_ps (&set[i]), valpha), vfloor);
+
+        _mm256_storeu_ps (&fuzzy_values[i], _mm256_max_ps (_mm256_loadu_ps (&fuzzy_values[i]), value));
+    }
+
+    ImplicationScalar (&fuzzy_values[i], &set[i], npoints - i, alpha, method);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+#else
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("avx2,fma")))
+static void ClipMaxAVX2 (fuzzy_t *fuzzy_values, const fuzzy_t *set, long npoints, double alpha)
+{
+    long i;
+    __m256d valpha = _mm256_set1_pd (alpha);
+
+    for (i = 0; i + 8 <= npoints; i += 8)
+    {
+        _mm256_storeu_pd (&fuzzy_values[i], _mm256_max_pd (_mm256_loadu_pd (&fuzzy_values[i]), _mm256_min_pd (_mm256_loadu_pd (&set[i]), valpha)));
+        _mm256_storeu_pd (&fuzzy_values[i + 4], _mm256_max_pd (_mm256_loadu_pd (&fuzzy_values[i + 4]), _mm256_min_pd (_mm256_loadu_pd (&set[i + 4]), valpha)));
+    }
+
+    ClipMaxScalar (&fuzzy_values[i], &set[i], npoints - i, alpha);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("avx2,fma")))
+static void ImplicationAVX2 (fuzzy_t *fuzzy_values, const fuzzy_t *set, long npoints, double alpha, int method)
+{
+    long i;
+    __m256d value;
+    __m256d valpha = _mm256_set1_pd (alpha);
+    __m256d vfloor = _mm256_set1_pd ((method == LARSEN) ? 0.0 : 1.0 - alpha);
+
+    for (i = 0; i + 4 <= npoints; i += 4)
+    {
+        if (method == LARSEN) value = _mm256_mul_pd (_mm256_loadu_pd (&set[i]), valpha);
+        else value = _mm256_max_pd (_mm256_min_pd (_mm256_loadu_pd (&set[i]), valpha), vfloor);
+
+        _mm256_storeu_pd (&fuzzy_values[i], _mm256_max_pd (_mm256_loadu_pd (&fuzzy_values[i]), value));
+    }
+
+    ImplicationScalar (&fuzzy_values[i], &set[i], npoints - i, alpha, method);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("avx2,fma")))
+static void OperatorAVX2 (double *values, const double *operand, long n, int op)
+{
+    long i;
+
+    for (i = 0; i + 4 <= n; i += 4)
+    {
+        if (op == AND) _mm256_storeu_pd (&values[i], _mm256_min_pd (_mm256_loadu_pd (&operand[i]), _mm256_loadu_pd (&values[i])));
+        else _mm256_storeu_pd (&values[i], _mm256_max_pd (_mm256_loadu_pd (&operand[i]), _mm256_loadu_pd (&values[i])));
+    }
+
+    OperatorScalar (&values[i], &operand[i], n - i, op);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("avx2,fma")))
+static void ShapePointsAVX2 (double *degrees, const double *points, long n, int type, const struct SShape *shape)
+{
+    long i;
+    long j;
+    double tail[4];
+
+    for (i = 0; i + 4 <= n; i += 4)
+        _mm256_storeu_pd (&degrees[i], ShapeAVX2 (_mm256_loadu_pd (&points[i]), type, shape));
+
+    if (i < n)
+    {
+        for (j = 0; j < 4; j++) tail[j] = points[(i + j < n) ? i + j : i];
+
+        _mm256_storeu_pd (tail, ShapeAVX2 (_mm256_loadu_pd (tail), type, shape));
+        for (j = 0; i < n; i++, j++) degrees[i] = tail[j];
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("avx2,fma")))
+static void LookupAVX2 (double *degrees, const fuzzy_t *column, long stride, const struct SUniverse *universe, const double *points, long n)
+{
+    long i;
+
+    __m256d x;
+    __m256d index;
+    __m256d start = _mm256_set1_pd (universe->start_uod);
+    __m256d scale = _mm256_set1_pd (universe->scale);
+    __m256d last = _mm256_set1_pd ((double) (universe->npoints - 1));
+    __m256d vstride = _mm256_set1_pd ((double) stride);
+    __m256d half = _mm256_set1_pd (0.5);
+    __m256d one = _mm256_set1_pd (1.0);
+
+    // the gather takes 32 bit indexes: a bigger table is read one point at a time
+    if ((double) (universe->npoints - 1) * (double) stride > GATHER_MAX_INDEX)
+    {
+        LookupScalar (degrees, column, stride, universe, points, n);
+        return;
+    }
+
+    // same rounding as UniversePosDisc (), the indexes are gathered 4 at a time
+    for (i = 0; i + 4 <= n; i += 4)
+    {
+        x = _mm256_max_pd (_mm256_mul_pd (_mm256_sub_pd (_mm256_loadu_pd (&points[i]), start), scale), _mm256_setzero_pd ());
+        index = _mm256_floor_pd (x);
+        index = _mm256_add_pd (index, _mm256_and_pd (_mm256_cmp_pd (_mm256_sub_pd (x, index), half, _CMP_GE_OQ), one));
+        index = _mm256_mul_pd (_mm256_min_pd (index, last), vstride);
+
+        _mm256_storeu_pd (&degrees[i], GatherAVX2 (column, _mm256_cvttpd_epi32 (index)));
+    }
+
+    LookupScalar (&degrees[i], column, stride, universe, &points[i], n - i);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("sse2")))
+static void ReductionSSE2 (const fuzzy_t *fuzzy_values, long npoints, long base, struct SReduction *reduction)
+{
+    long i;
+    int k;
+
+    double max[2];
+    double first[2];
+    double last[2];
+    double count[2];
+    double moment[2];
+    double sums[2];
+    double high[2];
+
+    __m128d x;
+    __m128d gt;
+    __m128d eq;
+    __m128d one = _mm_set1_pd (1.0);
+    __m128d two = _mm_set1_pd (2.0);
+    __m128d index = _mm_set_pd ((double) base + 1.0, (double) base);
+    __m128d vsum_low = _mm_setzero_pd ();
+    __m128d vsum_high = _mm_setzero_pd ();
+    __m128d vmoment_low = _mm_setzero_pd ();
+    __m128d vmoment_high = _mm_setzero_pd ();
+    __m128d vmax = _mm_set1_pd (-HUGE_VAL);
+    __m128d vfirst = _mm_setzero_pd ();
+    __m128d vlast = _mm_setzero_pd ();
+    __m128d vcount = _mm_setzero_pd ();
+    __m128d vmax_moment = _mm_setzero_pd ();
+
+    // the sums in the lanes 0, 1 (low) and 2, 3 (high) of the AVX2 kernel, so both levels add in the same
+    // order. Each lane keeps its own maximum, with the first/last index and the count of the points equal to it
+    for (i = 0; i + 4 <= npoints; i += 4)
+    {
+        x = LoadSSE2 (&fuzzy_values[i]);
+
+        vsum_low = _mm_add_pd (vsum_low, x);
+        vmoment_low = _mm_add_pd (vmoment_low, _mm_mul_pd (x, index));
+
+        gt = _mm_cmpgt_pd (x, vmax);
+        eq = _mm_cmpeq_pd (x, vmax);
+
+        vmax = BlendSSE2 (vmax, x, gt);
+        vfirst = BlendSSE2 (vfirst, index, gt);
+        vlast = BlendSSE2 (vlast, index, _mm_or_pd (gt, eq));
+        vcount = BlendSSE2 (_mm_add_pd (vcount, _mm_and_pd (eq, one)), one, gt);
+        vmax_moment = BlendSSE2 (_mm_add_pd (vmax_moment, _mm_and_pd (eq, index)), index, gt);
+
+        index = _mm_add_pd (index, two);
+        x = LoadSSE2 (&fuzzy_values[i + 2]);
+
+        vsum_high = _mm_add_pd (vsum_high, x);
+        vmoment_high = _mm_add_pd (vmoment_high, _mm_mul_pd (x, index));
+
+        gt = _mm_cmpgt_pd (x, vmax);
+        eq = _mm_cmpeq_pd (x, vmax);
+
+        vmax = BlendSSE2 (vmax, x, gt);
+        vfirst = BlendSSE2 (vfirst, index, gt);
+        vlast = BlendSSE2 (vlast, index, _mm_or_pd (gt, eq));
+        vcount = BlendSSE2 (_mm_add_pd (vcount, _mm_and_pd (eq, one)), one, gt);
+        vmax_moment = BlendSSE2 (_mm_add_pd (vmax_moment, _mm_and_pd (eq, index)), index, gt);
+
+        index = _mm_add_pd (index, two);
+    }
+
+    _mm_storeu_pd (sums, vsum_low);
+    _mm_storeu_pd (high, vsum_high);
+    reduction->sum = (sums[0] + sums[1]) + (high[0] + high[1]);
+    _mm_storeu_pd (sums, vmoment_low);
+    _mm_storeu_pd (high, vmoment_high);
+    reduction->moment = (sums[0] + sums[1]) + (high[0] + high[1]);
+
+    _mm_storeu_pd (max, vmax);
+    _mm_storeu_pd (first, vfirst);
+    _mm_storeu_pd (last, vlast);
+    _mm_storeu_pd (count, vcount);
+    _mm_storeu_pd (moment, vmax_moment);
+
+    for (k = 0; k < 2; k++)
+        MergeMaximum (reduction, max[k], (long) first[k], (long) last[k], (long) count[k], moment[k]);
+
+    for (; i < npoints; i++)
+    {
+        reduction->sum += fuzzy_values[i];
+        reduction->moment += fuzzy_values[i] * (double) (base + i);
+
+        MergeMaximum (reduction, fuzzy_values[i], base + i, base + i, 1, (double) (base + i));
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("avx2,fma")))
+static void ReductionAVX2 (const fuzzy_t *fuzzy_values, long npoints, long base, struct SReduction *reduction)
+{
+    long i;
+    int k;
+
+    double max[4];
+    double first[4];
+    double last[4];
+    double count[4];
+    double moment[4];
+    double sums[4];
+
+    __m256d x;
+    __m256d gt;
+    __m256d eq;
+    __m256d one = _mm256_set1_pd (1.0);
+    __m256d index = _mm256_set_pd ((double) base + 3.0, (double) base + 2.0, (double) base + 1.0, (double) base);
+    __m256d vsum = _mm256_setzero_pd ();
+    __m256d vmoment = _mm256_setzero_pd ();
+    __m256d vmax = _mm256_set1_pd (-HUGE_VAL);
+    __m256d vfirst = _mm256_setzero_pd ();
+    __m256d vlast = _mm256_setzero_pd ();
+    __m256d vcount = _mm256_setzero_pd ();
+    __m256d vmax_moment = _mm256_setzero_pd ();
+
+    for (i = 0; i + 4 <= npoints; i += 4)
+    {
+        x = LoadAVX2 (&fuzzy_values[i]);
+
+        vsum = _mm256_add_pd (vsum, x);
+        vmoment = _mm256_add_pd (vmoment, ProductAVX2 (x, index));
+
+        gt = _mm256_cmp_pd (x, vmax, _CMP_GT_OQ);
+        eq = _mm256_cmp_pd (x, vmax, _CMP_EQ_OQ);
+
+        vmax = _mm256_blendv_pd (vmax, x, gt);
+        vfirst = _mm256_blendv_pd (vfirst, index, gt);
+        vlast = _mm256_blendv_pd (vlast, index, _mm256_or_pd (gt, eq));
+        vcount = _mm256_blendv_pd (_mm256_add_pd (vcount, _mm256_and_pd (eq, one)), one, gt);
+        vmax_moment = _mm256_blendv_pd (_mm256_add_pd (vmax_moment, _mm256_and_pd (eq, index)), index, gt);
+
+        index = _mm256_add_pd (index, _mm256_set1_pd (4.0));
+    }
+
+    _mm256_storeu_pd (sums, vsum);
+    reduction->sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    _mm256_storeu_pd (sums, vmoment);
+    reduction->moment = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+
+    _mm256_storeu_pd (max, vmax);
+    _mm256_storeu_pd (first, vfirst);
+    _mm256_storeu_pd (last, vlast);
+    _mm256_storeu_pd (count, vcount);
+    _mm256_storeu_pd (moment, vmax_moment);
+
+    for (k = 0; k < 4; k++)
+        MergeMaximum (reduction, max[k], (long) first[k], (long) last[k], (long) count[k], moment[k]);
+
+    for (; i < npoints; i++)
+    {
+        reduction->sum += fuzzy_values[i];
+        reduction->moment += TailProductAVX2 (fuzzy_values[i], (double) (base + i));
+
+        MergeMaximum (reduction, fuzzy_values[i], base + i, base + i, 1, (double) (base + i));
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("sse2")))
+static void MomentSSE2 (const fuzzy_t *values, long npoints, long base, double *sum, double *moment)
+{
+    long i;
+    double sums[2];
+    double high[2];
+
+    __m128d x;
+    __m128d two = _mm_set1_pd (2.0);
+    __m128d index = _mm_set_pd ((double) base + 1.0, (double) base);
+    __m128d vsum_low = _mm_setzero_pd ();
+    __m128d vsum_high = _mm_setzero_pd ();
+    __m128d vmoment_low = _mm_setzero_pd ();
+    __m128d vmoment_high = _mm_setzero_pd ();
+
+    // the lanes of ReductionSSE2 ()
+    for (i = 0; i + 4 <= npoints; i += 4)
+    {
+        x = LoadSSE2 (&values[i]);
+        vsum_low = _mm_add_pd (vsum_low, x);
+        vmoment_low = _mm_add_pd (vmoment_low, _mm_mul_pd (x, index));
+        index = _mm_add_pd (index, two);
+
+        x = LoadSSE2 (&values[i + 2]);
+        vsum_high = _mm_add_pd (vsum_high, x);
+        vmoment_high = _mm_add_pd (vmoment_high, _mm_mul_pd (x, index));
+        index = _mm_add_pd (index, two);
+    }
+
+    _mm_storeu_pd (sums, vsum_low);
+    _mm_storeu_pd (high, vsum_high);
+    *sum = (sums[0] + sums[1]) + (high[0] + high[1]);
+    _mm_storeu_pd (sums, vmoment_low);
+    _mm_storeu_pd (high, vmoment_high);
+    *moment = (sums[0] + sums[1]) + (high[0] + high[1]);
+
+    for (; i < npoints; i++)
+    {
+        *sum += values[i];
+        *moment += values[i] * (double) (base + i);
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+__attribute__ ((target ("avx2,fma")))
+static void MomentAVX2 (const fuzzy_t *values, long npoints, long base, double *sum, double *moment)
+{
+    long i;
+    double sums[4];
+    double moments[4];
+
+    __m256d x;
+    __m256d index = _mm256_set_pd ((double) base + 3.0, (double) base + 2.0, (double) base + 1.0, (double) base);
+    __m256d vsum = _mm256_setzero_pd ();
+    __m256d vmoment = _mm256_setzero_pd ();
+
+    for (i = 0; i + 4 <= npoints; i += 4)
+    {
+        x = LoadAVX2 (&values[i]);
+        vsum = _mm256_add_pd (vsum, x);
+        vmoment = _mm256_add_pd (vmoment, ProductAVX2 (x, index));
+        index = _mm256_add_pd (index, _mm256_set1_pd (4.0));
+    }
+
+    _mm256_storeu_pd (sums, vsum);
+    _mm256_storeu_pd (moments, vmoment);
+
+    *sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    *moment = (moments[0] + moments[1]) + (moments[2] + moments[3]);
+
+    for (; i < npoints; i++)
+    {
+        *sum += values[i];
+        *moment += TailProductAVX2 (values[i], (double) (base + i));
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
+static int DetectKernelLevel (void)
+{
+#ifdef KERNELS_X86
+    __builtin_cpu_init ();
+
+    if (__builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma")) return KERNEL_AVX2;
+    if (__builtin_cpu_supports ("sse2")) return KERNEL_SSE2;
+#endif
+
+    return KERNEL_SCALAR;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int KernelLevel (void)
+{
+    int level;
+
+    level = LOAD_LEVEL ();
+    if (level < 0)
+    {
+        level = DetectKernelLevel ();
+        STORE_LEVEL (level);
+    }
+
+    return level;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int SetKernelLevel (int level)
+{
+    int supported;
+
+    supported = DetectKernelLevel ();
+    if (level > supported) level = supported;
+    if (level < KERNEL_SCALAR) level = KERNEL_SCALAR;
+
+    STORE_LEVEL (level);
+
+    return level;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void MembershipKernel (fuzzy_t *values, long npoints, double start_uod, double step, int type, const double *params)
+{
+    struct SShape shape;
+
+    ShapeParams (type, params, &shape);
+
+    switch (KernelLevel ())
+    {
+#ifdef KERNELS_X86
+        case KERNEL_AVX2:   MembershipAVX2 (values, npoints, start_uod, step, type, &shape);
+                            return;
+
+        case KERNEL_SSE2:   MembershipSSE2 (values, npoints, start_uod, step, type, &shape);
+                            return;
+#endif
+        default:            MembershipScalar (values, npoints, start_uod, step, type, &shape);
+                            return;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void ClipMaxKernel (fuzzy_t *fuzzy_values, const fuzzy_t *set, long npoints, double alpha)
+{
+    // a rule that does not fire leaves the aggregation unchanged
+    if (! (alpha > 0)) return;
+
+    switch (KernelLevel ())
+    {
+#ifdef KERNELS_X86
+        case KERNEL_AVX2:   ClipMaxAVX2 (fuzzy_values, set, npoints, alpha);
+                            return;
+
+        case KERNEL_SSE2:   ClipMaxSSE2 (fuzzy_values, set, npoints, alpha);
+                            return;
+#endif
+        default:            ClipMaxScalar (fuzzy_values, set, npoints, alpha);
+                            return;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void ImplicationKernel (fuzzy_t *fuzzy_values, const fuzzy_t *set, long npoints, double alpha, int method)
+{
+    if (method == MANDANI)
+    {
+        ClipMaxKernel (fuzzy_values, set, npoints, alpha);
+        return;
+    }
+
+    // a LARSEN rule that does not fire adds nothing, a ZADEH one still raises everything to 1 - alpha
+    if ((method == LARSEN) && (! (alpha > 0))) return;
+
+    switch (KernelLevel ())
+    {
+#ifdef KERNELS_X86
+        case KERNEL_AVX2:   ImplicationAVX2 (fuzzy_values, set, npoints, alpha, method);
+                            return;
+
+        case KERNEL_SSE2:   ImplicationSSE2 (fuzzy_values, set, npoints, alpha, method);
+                            return;
+#endif
+        default:            ImplicationScalar (fuzzy_values, set, npoints, alpha, method);
+                            return;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void OperatorKernel (double *values, const double *operand, long n, int op)
+{
+    switch (KernelLevel ())
+    {
+#ifdef KERNELS_X86
+        case KERNEL_AVX2:   OperatorAVX2 (values, operand, n, op);
+                            return;
+
+        case KERNEL_SSE2:   OperatorSSE2 (values, operand, n, op);
+                            return;
+#endif
+        default:            OperatorScalar (values, operand, n, op);
+                            return;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void DegreeKernel (double *degrees, const struct SSets *set, const double *points, long n)
+{
+    long i;
+    int level;
+
+    struct SShape shape;
+
+    level = KernelLevel ();
+
+    if (set->mode == MEMBERSHIP_ANALYTIC)
+    {
+        ShapeParams (set->type, set->params, &shape);
+
+        switch (level)
+        {
+#ifdef KERNELS_X86
+            case KERNEL_AVX2:   ShapePointsAVX2 (degrees, points, n, set->type, &shape);
+                                return;
+
+            case KERNEL_SSE2:   ShapePointsSSE2 (degrees, points, n, set->type, &shape);
+                                return;
+#endif
+            default:            for (i = 0; i < n; i++) degrees[i] = MembershipValue (set->type, set->params, points[i]);
+                                return;
+        }
+    }
+
+#ifdef KERNELS_X86
+    if (level == KERNEL_AVX2)
+    {
+        if (set->mode == MEMBERSHIP_INTERLEAVED) LookupAVX2 (degrees, &set->degrees[set->term], set->stride, set->universe, points, n);
+        else LookupAVX2 (degrees, set->value, 1, set->universe, points, n);
+
+        return;
+    }
+#endif
+
+    if (set->mode == MEMBERSHIP_INTERLEAVED) LookupScalar (degrees, &set->degrees[set->term], set->stride, set->universe, points, n);
+    else LookupScalar (degrees, set->value, 1, set->universe, points, n);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static void PairwisePush (double *stack, int *depth, long count, double value)
+{
+    // the stack holds sums of 2^k blocks: two sums of the same size are added together (binary carry)
+    stack[(*depth)++] = value;
+
+    for (; ! (count & 1); count >>= 1)
+    {
+        (*depth)--;
+        stack[*depth - 1] += stack[*depth];
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static double PairwiseTotal (const double *stack, int depth)
+{
+    double total;
+
+    // smallest partial sums first
+    for (total = 0; depth > 0; depth--) total += stack[depth - 1];
+
+    return total;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void ReductionKernel (const fuzzy_t *fuzzy_values, long npoints, struct SReduction *reduction)
+{
+    long i;
+    long n;
+    long nblocks;
+    int level;
+    int sum_depth;
+    int moment_depth;
+
+    double sum_stack[PAIRWISE_DEPTH];
+    double moment_stack[PAIRWISE_DEPTH];
+
+    struct SReduction block;
+
+    level = KernelLevel ();
+
+    ResetReduction (reduction);
+    sum_depth = 0;
+    moment_depth = 0;
+    nblocks = 0;
+
+    for (i = 0; i < npoints; i = i + REDUCTION_BLOCK)
+    {
+        n = npoints - i;
+        if (n > REDUCTION_BLOCK) n = REDUCTION_BLOCK;
+
+        ResetReduction (&block);
+
+        switch (level)
+        {
+#ifdef KERNELS_X86
+            case KERNEL_AVX2:   ReductionAVX2 (&fuzzy_values[i], n, i, &block);
+                                break;
+
+            case KERNEL_SSE2:   ReductionSSE2 (&fuzzy_values[i], n, i, &block);
+                                break;
+#endif
+            default:            ReductionScalar (&fuzzy_values[i], n, i, &block);
+                                break;
+        }
+
+        nblocks++;
+        PairwisePush (sum_stack, &sum_depth, nblocks, block.sum);
+        PairwisePush (moment_stack, &moment_depth, nblocks, block.moment);
+
+        MergeMaximum (reduction, block.max, block.first_max, block.last_max, block.nmax, block.max_moment);
+    }
+
+    reduction->sum = PairwiseTotal (sum_stack, sum_depth);
+    reduction->moment = PairwiseTotal (moment_stack, moment_depth);
+
+    if (npoints == 0) reduction->max = 0;
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void AggregationKernel (fuzzy_t *fuzzy_values, const struct SSets *output_set, const int *memberships, const double *alphas, int n,
+                        int method, double *sum, double *moment)
+{
+    long i;
+    long m;
+    long npoints;
+    long nblocks;
+    long first;
+    long last;
+    long lo;
+    long hi;
+    int k;
+    int level;
+    int sum_depth;
+    int moment_depth;
+
+    double block_sum;
+    double block_moment;
+    fuzzy_t block[REDUCTION_BLOCK];
+    double sum_stack[PAIRWISE_DEPTH];
+    double moment_stack[PAIRWISE_DEPTH];
+
+    const struct SSets *output;
+
+    npoints = output_set[0].npoints;
+    level = KernelLevel ();
+
+    // window of the aggregate: MANDANI and LARSEN only write the supports of the fired memberships
+    if (method == ZADEH)
+    {
+        first = 0;
+        last = npoints - 1;
+    }
+    else
+    {
+        first = npoints;
+        last = -1;
+
+        for (k = 0; k < n; k++)
+        {
+            output = &output_set[memberships[k]];
+            if ((! (alphas[k] > 0)) || (output->first > output->last)) continue;
+
+            if (output->first < first) first = output->first;
+            if (output->last > last) last = output->last;
+        }
+    }
+
+    if (fuzzy_values != NULL)
+    {
+        if (first > last) memset (fuzzy_values, 0, sizeof (fuzzy_t) * npoints);
+        else
+        {
+            memset (fuzzy_values, 0, sizeof (fuzzy_t) * first);
+            memset (&fuzzy_values[last + 1], 0, sizeof (fuzzy_t) * (npoints - last - 1));
+        }
+    }
+
+    sum_depth = 0;
+    moment_depth = 0;
+    nblocks = 0;
+
+    for (i = first; i <= last; i = i + REDUCTION_BLOCK)
+    {
+        m = last + 1 - i;
+        if (m > REDUCTION_BLOCK) m = REDUCTION_BLOCK;
+
+        memset (block, 0, sizeof (fuzzy_t) * m);
+
+        for (k = 0; k < n; k++)
+        {
+            output = &output_set[memberships[k]];
+
+            if (method == ZADEH)
+            {
+                ImplicationKernel (block, &output->value[i], m, alphas[k], method);
+                continue;
+            }
+
+            // part of the support of the membership inside the block
+            lo = (output->first > i) ? output->first : i;
+            hi = (output->last < i + m - 1) ? output->last : i + m - 1;
+
+            if (lo <= hi) ImplicationKernel (&block[lo - i], &output->value[lo], hi - lo + 1, alphas[k], method);
+        }
+
+        if (fuzzy_values != NULL) memcpy (&fuzzy_values[i], block, sizeof (fuzzy_t) * m);
+
+        switch (level)
+        {
+#ifdef KERNELS_X86
+            case KERNEL_AVX2:   MomentAVX2 (block, m, i, &block_sum, &block_moment);
+                                break;
+
+            case KERNEL_SSE2:   MomentSSE2 (block, m, i, &block_sum, &block_moment);
+                                break;
+#endif
+            default:            MomentScalar (block, m, i, &block_sum, &block_moment);
+                                break;
+        }
+
+        nblocks++;
+        PairwisePush (sum_stack, &sum_depth, nblocks, block_sum);
+        PairwisePush (moment_stack, &moment_depth, nblocks, block_moment);
+    }
+
+    *sum = PairwiseTotal (sum_stack, sum_depth);
+    *moment = PairwiseTotal (moment_stack, moment_depth);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,336 @@
+/**
+ * @file
+ * @author  Andre Silva <andreluizeng@yahoo.com.br>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2012, Andre Luiz Vieira da Silva
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this software
+ *    must display the following acknowledgement:
+ *    This product includes software developed by the <organization>.
+ * 4. Neither the name of the <organization> nor the
+ *    names of its contributors may be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Andre Silva ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Andre Silva BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @section DESCRIPTION
+ *
+ */
+
+#include "surface.h"
+#include "fisutils.h"
+#include "rulebase.h"
+
+//-------------------------------------------------------------------------------------------------
+static int NextIndex (int *index, const int *limit, int n)
+{
+    int i;
+
+    // odometer increment, the first input changes fastest (as the table strides)
+    for (i = 0; i < n; i++)
+    {
+        index[i]++;
+        if (index[i] < limit[i]) return TRUE;
+        index[i] = 0;
+    }
+
+    return FALSE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int SampleSurface (struct SSurface *surface, struct SRuleBase *rules)
+{
+    int i;
+    int index[SURFACE_MAX_INPUTS];
+    long node;
+
+    double range;
+    double inputs[SURFACE_MAX_INPUTS];
+    double *aux;
+
+    for (i = 0, surface->nnodes = 1; i < surface->ninputs; i++)
+    {
+        range = rules->inputs[i][0].stop_uod - rules->inputs[i][0].start_uod;
+
+        surface->start[i] = rules->inputs[i][0].start_uod;
+        surface->scale[i] = (surface->resolution[i] - 1) / range;
+        surface->stride[i] = surface->nnodes;
+        surface->nnodes *= surface->resolution[i];
+    }
+
+    aux = (double *) realloc (surface->table, sizeof (double) * surface->nnodes * surface->noutputs);
+    if (aux == NULL)
+    {
+        printf ("\nError on allocating memory: CompileSurface ()\n");
+        return FALSE;
+    }
+
+    surface->table = aux;
+
+    memset (index, 0, sizeof (index));
+    node = 0;
+
+    do
+    {
+        for (i = 0; i < surface->ninputs; i++)
+        {
+            range = rules->inputs[i][0].stop_uod - rules->inputs[i][0].start_uod;
+            inputs[i] = surface->start[i] + range * index[i] / (surface->resolution[i] - 1);
+        }
+
+        if (! Evaluate (rules, inputs, &surface->table[node * surface->noutputs]))
+        {
+            printf ("\nError: rule base evaluation failed: CompileSurface ()\n");
+            return FALSE;
+        }
+
+        node++;
+    }
+    while (NextIndex (index, surface->resolution, surface->ninputs));
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+static int SurfaceError (struct SSurface *surface, struct SRuleBase *rules, double *exact, double *approx)
+{
+    int i;
+    int o;
+    int split;
+    int node;
+    int index[SURFACE_MAX_INPUTS];
+    int limit[SURFACE_MAX_INPUTS];
+
+    double inputs[SURFACE_MAX_INPUTS];
+
+    // each cell is split in the same number of parts along every input, as many as SURFACE_ERROR_SAMPLES
+    // evaluations per cell allow (at least 2: the middle of each edge, the centre of each face and of the cell)
+    split = 2;
+    while (pow (split + 1, surface->ninputs) <= SURFACE_ERROR_SAMPLES) split++;
+
+    for (i = 0; i < surface->ninputs; i++) limit[i] = split * (surface->resolution[i] - 1) + 1;
+
+    memset (index, 0, sizeof (index));
+    surface->max_error = 0;
+
+    // every point of the split grid but the nodes (where the table holds the rule base outputs)
+    do
+    {
+        for (i = 0, node = TRUE; i < surface->ninputs; i++) if (index[i] % split) node = FALSE;
+        if (node) continue;
+
+        for (i = 0; i < surface->ninputs; i++) inputs[i] = surface->start[i] + ((double) index[i] / split) / surface->scale[i];
+
+        if (! Evaluate (rules, inputs, exact))
+        {
+            printf ("\nError: rule base evaluation failed: CompileSurface ()\n");
+            return FALSE;
+        }
+
+        EvaluateSurface (surface, inputs, approx);
+
+        for (o = 0; o < surface->noutputs; o++) surface->max_error = Maximum (surface->max_error, fabs (exact[o] - approx[o]));
+    }
+    while (NextIndex (index, limit, surface->ninputs));
+
+    return TRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+int CompileSurface (struct SSurface **surface, struct SRuleBase *rules, const int *resolution, double target_error, long max_nodes)
+{
+    int i;
+    int status;
+
+    double nodes;
+    double *exact;
+
+    struct SSurface *aux;
+
+    if (! rules->compiled)
+    {
+        printf ("\nError: rule base not compiled: CompileSurface ()\n");
+        return FALSE;
+    }
+
+    if (rules->ninputs > SURFACE_MAX_INPUTS)
+    {
+        printf ("\nError: more than %d input variables: CompileSurface ()\n", SURFACE_MAX_INPUTS);
+        return FALSE;
+    }
+
+    for (i = 0, nodes = 1; i < rules->ninputs; i++)
+    {
+        if (resolution[i] < 2)
+        {
+            printf ("\nError: invalid resolution %d of input variable %d: CompileSurface ()\n", resolution[i], i);
+            return FALSE;
+        }
+
+        nodes *= resolution[i];
+    }
+
+    if (nodes > max_nodes)
+    {
+        printf ("\nError: grid bigger than %ld nodes: CompileSurface ()\n", max_nodes);
+        return FALSE;
+    }
+
+    aux = (struct SSurface *) malloc (sizeof (struct SSurface));
+    if (aux == NULL)
+    {
+        printf ("\nError on allocating memory: CompileSurface ()\n");
+        return FALSE;
+    }
+
+    memset (aux, 0, sizeof (struct SSurface));
+
+    aux->ninputs = rules->ninputs;
+    aux->noutputs = rules->noutputs;
+    aux->resolution = (int *) malloc (sizeof (int) * rules->ninputs);
+    aux->start = (double *) malloc (sizeof (double) * rules->ninputs);
+    aux->scale = (double *) malloc (sizeof (double) * rules->ninputs);
+    aux->stride = (long *) malloc (sizeof (long) * rules->ninputs);
+
+    exact = (double *) malloc (sizeof (double) * rules->noutputs * 2);
+
+    if ((aux->resolution == NULL) || (aux->start == NULL) || (aux->scale == NULL) || (aux->stride == NULL) || (exact == NULL))
+    {
+        printf ("\nError on allocating memory: CompileSurface ()\n");
+        free (exact);
+        FreeSurface (aux);
+        return FALSE;
+    }
+
+    memcpy (aux->resolution, resolution, sizeof (int) * rules->ninputs);
+
+    status = TRUE;
+
+    while (TRUE)
+    {
+        if ((! SampleSurface (aux, rules)) || (! SurfaceError (aux, rules, exact, exact + rules->noutputs)))
+        {
+            free (exact);
+            FreeSurface (aux);
+            return FALSE;
+        }
+
+        if ((target_error <= 0) || (aux->max_error <= target_error)) break;
+
+        // every cell split in two keeps the current nodes on the new grid
+        for (i = 0, nodes = 1; i < aux->ninputs; i++) nodes *= 2.0 * aux->resolution[i] - 1;
+        if (nodes > max_nodes)
+        {
+            status = SURFACE_COARSE;
+            break;
+        }
+
+        for (i = 0; i < aux->ninputs; i++) aux->resolution[i] = 2 * aux->resolution[i] - 1;
+    }
+
+    free (exact);
+
+    (* surface) = aux;
+
+    return status;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void FreeSurface (struct SSurface *surface)
+{
+    if (surface == NULL) return;
+
+    free (surface->resolution);
+    free (surface->start);
+    free (surface->scale);
+    free (surface->stride);
+    free (surface->table);
+    free (surface);
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+void EvaluateSurface (const struct SSurface *surface, const double *inputs, double *outputs)
+{
+    int i;
+    int o;
+    int corner;
+    int ncorners;
+    long cell;
+    long node;
+    long base;
+
+    double x;
+    double weight;
+    double fraction[SURFACE_MAX_INPUTS];
+
+    const double *row;
+
+    base = 0;
+
+    for (i = 0; i < surface->ninputs; i++)
+    {
+        // grid coordinate clamped to the universe (NaN goes to the first node)
+        x = (inputs[i] - surface->start[i]) * surface->scale[i];
+        if (! (x > 0)) x = 0;
+        if (x > surface->resolution[i] - 1) x = surface->resolution[i] - 1;
+
+        cell = (long) x;
+        if (cell == surface->resolution[i] - 1) cell--;
+
+        fraction[i] = x - cell;
+        base += cell * surface->stride[i];
+    }
+
+    for (o = 0; o < surface->noutputs; o++) outputs[o] = 0;
+
+    ncorners = 1 << surface->ninputs;
+
+    for (corner = 0; corner < ncorners; corner++)
+    {
+        weight = 1;
+        node = base;
+
+        for (i = 0; i < surface->ninputs; i++)
+        {
+            if (corner & (1 << i))
+            {
+                weight *= fraction[i];
+                node += surface->stride[i];
+            }
+            else weight *= 1 - fraction[i];
+        }
+
+        row = &surface->table[node * surface->noutputs];
+        for (o = 0; o < surface->noutputs; o++) outputs[o] += weight * row[o];
+    }
+
+    return;
+}
+//-------------------------------------------------------------------------------------------------